@@ -68,7 +68,7 @@ namespace Ciallang::Syntax {
         return makeNode<ProcCallExprNode>(lhs);
     }
 
-    AssignExprNode* AstBuilder::makeAssignExprNode(const IdentifierExprNode* lhs, const ExprNode* rhs) {
+    AssignExprNode* AstBuilder::makeAssignExprNode(const ExprNode* lhs, const ExprNode* rhs) {
         return makeNode<AssignExprNode>(lhs, rhs);
     }
 
@@ -42,7 +42,7 @@ namespace Ciallang::Syntax {
 
         ProcCallExprNode* makeProcCallExprNode(const ExprNode* lhs);
 
-        AssignExprNode* makeAssignExprNode(const IdentifierExprNode* lhs,
+        AssignExprNode* makeAssignExprNode(const ExprNode* lhs,
                                            const ExprNode* rhs);
 
         IdentifierExprNode* makeSymbolExprNode(Token&& token);
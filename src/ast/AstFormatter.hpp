@@ -76,7 +76,7 @@ namespace Ciallang {
             increaseIndent();
             for(auto& [token,exprNode] : node->parameters) {
                 CHECK(token.value()->isString());
-                printNode(*token.value()->asString(), exprNode);
+                printNode(std::string{ token.value()->asString() }, exprNode);
             }
             decreaseIndent();
 
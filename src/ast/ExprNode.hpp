@@ -124,13 +124,14 @@ namespace Ciallang::Syntax {
 
     class AssignExprNode final : public ExprNode {
     public:
-        const IdentifierExprNode* lhs;
+        // 标识符或者成员访问 (obj.name)
+        const ExprNode* lhs;
         const ExprNode* rhs;
 
         AssignExprNode() = delete;
 
         explicit AssignExprNode(
-            const IdentifierExprNode* lhs,
+            const ExprNode* lhs,
             const ExprNode* rhs
         ) : ExprNode("assignment_expression"), lhs(lhs), rhs(rhs) {
             location.start(lhs->location.start());
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2024/11/3 下午3:20
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CIALLANG_FLAT_HASH_MAP_SSE2 1
+#endif
+
+namespace Ciallang::Collections {
+    /**
+     * 开放寻址哈希表 (Swiss table)
+     *
+     * 每个槽位对应一个控制字节: 空, 已删除, 或者哈希值的低 7 位 (h2).
+     * 槽位按 16 个一组探测, 一次比较整组控制字节找出 h2 相同的候选,
+     * 只有候选才需要比较键. 组内有空槽位时说明键不存在, 探测结束
+     *
+     * 参考: Abseil SwissTable 设计 (Matt Kulukundis, CppCon 2017)
+     */
+    template <
+        typename K,
+        typename V,
+        typename Hash = std::hash<K>,
+        typename Eq = std::equal_to<K>
+    >
+    class FlatHashMap {
+        static constexpr size_t GROUP_SIZE = 16;
+
+        static constexpr int8_t CTRL_EMPTY = -128;
+        static constexpr int8_t CTRL_DELETED = -2;
+
+        struct Slot {
+            K key;
+            V value;
+        };
+
+        // 组内控制字节的匹配结果, 第 i 位对应组内第 i 个槽位
+        class BitMask {
+        public:
+            explicit BitMask(const uint32_t mask) : _mask(mask) {
+            }
+
+            explicit operator bool() const noexcept { return _mask != 0; }
+
+            [[nodiscard]] uint32_t lowest() const noexcept { return std::countr_zero(_mask); }
+
+            void next() noexcept { _mask &= _mask - 1; }
+
+        private:
+            uint32_t _mask;
+        };
+
+        struct Group {
+            explicit Group(const int8_t* ctrl) {
+#ifdef CIALLANG_FLAT_HASH_MAP_SSE2
+                _ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+                std::memcpy(_ctrl, ctrl, GROUP_SIZE);
+#endif
+            }
+
+            [[nodiscard]] BitMask match(const int8_t h2) const noexcept {
+#ifdef CIALLANG_FLAT_HASH_MAP_SSE2
+                return BitMask(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl)));
+#else
+                uint32_t mask = 0;
+                for(size_t i = 0; i < GROUP_SIZE; ++i) {
+                    if(_ctrl[i] == h2) mask |= 1u << i;
+                }
+                return BitMask(mask);
+#endif
+            }
+
+            [[nodiscard]] BitMask matchEmpty() const noexcept {
+                return match(CTRL_EMPTY);
+            }
+
+            // 空和已删除的控制字节最高位为 1
+            [[nodiscard]] BitMask matchEmptyOrDeleted() const noexcept {
+#ifdef CIALLANG_FLAT_HASH_MAP_SSE2
+                return BitMask(_mm_movemask_epi8(_ctrl));
+#else
+                uint32_t mask = 0;
+                for(size_t i = 0; i < GROUP_SIZE; ++i) {
+                    if(_ctrl[i] < 0) mask |= 1u << i;
+                }
+                return BitMask(mask);
+#endif
+            }
+
+#ifdef CIALLANG_FLAT_HASH_MAP_SSE2
+            __m128i _ctrl;
+#else
+            int8_t _ctrl[GROUP_SIZE];
+#endif
+        };
+
+    public:
+        FlatHashMap() = default;
+
+        FlatHashMap(const FlatHashMap& other) {
+            if(other.empty()) return;
+
+            reserve(other._size);
+            other.forEach([this](const K& key, const V& value) {
+                tryEmplace(key, value);
+            });
+        }
+
+        FlatHashMap(FlatHashMap&& other) noexcept { swap(other); }
+
+        FlatHashMap& operator=(FlatHashMap other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~FlatHashMap() { destroy(); }
+
+        [[nodiscard]] size_t size() const noexcept { return _size; }
+
+        [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+
+        [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+
+        V* find(const K& key) {
+            const auto index = findIndex(key);
+            return index == npos ? nullptr : &_slots[index].value;
+        }
+
+        const V* find(const K& key) const {
+            const auto index = findIndex(key);
+            return index == npos ? nullptr : &_slots[index].value;
+        }
+
+        [[nodiscard]] bool contains(const K& key) const { return findIndex(key) != npos; }
+
+        // 键不存在时用 args 构造值, 返回值的位置以及是否新插入
+        template <typename... Args>
+        std::pair<V*, bool> tryEmplace(const K& key, Args&&... args) {
+            const auto hash = mix(key);
+            if(const auto index = findIndex(key, hash); index != npos) {
+                return { &_slots[index].value, false };
+            }
+
+            if(_size + _deleted + 1 > maxLoad(_capacity)) {
+                // 删除的槽位较多时原地重建即可
+                if(_capacity == 0) {
+                    rehash(GROUP_SIZE);
+                } else {
+                    rehash(_size + 1 > maxLoad(_capacity) / 2 ? _capacity * 2 : _capacity);
+                }
+            }
+
+            const auto index = findInsertIndex(hash);
+            if(_ctrl[index] == CTRL_DELETED) --_deleted;
+            _ctrl[index] = h2(hash);
+            new(&_slots[index]) Slot{ key, V(std::forward<Args>(args)...) };
+            ++_size;
+            return { &_slots[index].value, true };
+        }
+
+        template <typename T>
+        V& insertOrAssign(const K& key, T&& value) {
+            auto [slot, inserted] = tryEmplace(key, std::forward<T>(value));
+            if(!inserted) *slot = V(std::forward<T>(value));
+            return *slot;
+        }
+
+        V& operator[](const K& key) { return *tryEmplace(key).first; }
+
+        bool erase(const K& key) {
+            const auto index = findIndex(key);
+            if(index == npos) return false;
+
+            _slots[index].~Slot();
+            // 组内还有空槽位时, 经过这一组的探测本来就会停下, 不需要墓碑
+            const auto group = index & ~(GROUP_SIZE - 1);
+            if(Group(_ctrl + group).matchEmpty()) {
+                _ctrl[index] = CTRL_EMPTY;
+            } else {
+                _ctrl[index] = CTRL_DELETED;
+                ++_deleted;
+            }
+            --_size;
+            return true;
+        }
+
+        void clear() {
+            destroy();
+            _ctrl = nullptr;
+            _slots = nullptr;
+            _capacity = _size = _deleted = 0;
+        }
+
+        void reserve(const size_t count) {
+            size_t capacity = _capacity == 0 ? GROUP_SIZE : _capacity;
+            while(maxLoad(capacity) < count) capacity <<= 1;
+            if(capacity != _capacity) rehash(capacity);
+        }
+
+        template <typename F>
+        void forEach(F&& callback) const {
+            for(size_t i = 0; i < _capacity; ++i) {
+                if(_ctrl[i] >= 0) callback(_slots[i].key, _slots[i].value);
+            }
+        }
+
+        template <typename F>
+        void forEach(F&& callback) {
+            for(size_t i = 0; i < _capacity; ++i) {
+                if(_ctrl[i] >= 0) callback(_slots[i].key, _slots[i].value);
+            }
+        }
+
+        void swap(FlatHashMap& other) noexcept {
+            std::swap(_ctrl, other._ctrl);
+            std::swap(_slots, other._slots);
+            std::swap(_capacity, other._capacity);
+            std::swap(_size, other._size);
+            std::swap(_deleted, other._deleted);
+        }
+
+    private:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        int8_t* _ctrl{ nullptr };
+        Slot* _slots{ nullptr };
+        size_t _capacity{ 0 };
+        size_t _size{ 0 };
+        size_t _deleted{ 0 };
+
+        // 负载因子 7/8
+        static constexpr size_t maxLoad(const size_t capacity) noexcept {
+            return capacity - capacity / 8;
+        }
+
+        // 调用方的哈希可能是恒等映射 (例如指针), 再打散一次
+        static uint64_t mix(const K& key) {
+            auto hash = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+            return hash ^ (hash >> 32);
+        }
+
+        static int8_t h2(const uint64_t hash) noexcept {
+            return static_cast<int8_t>(hash & 0x7F);
+        }
+
+        static size_t h1(const uint64_t hash) noexcept {
+            return static_cast<size_t>(hash >> 7);
+        }
+
+        // 按组做二次探测, 组数是 2 的幂时能遍历所有组
+        // visit 返回空表示继续探测下一组, 否则以它的值作为结果
+        template <typename F>
+        size_t probe(const uint64_t hash, F&& visit) const {
+            const size_t groups = _capacity / GROUP_SIZE;
+            size_t group = h1(hash) & (groups - 1);
+            for(size_t step = 1; step <= groups; ++step) {
+                if(const auto result = visit(group * GROUP_SIZE)) return result.value();
+                group = (group + step) & (groups - 1);
+            }
+            return npos;
+        }
+
+        size_t findIndex(const K& key) const {
+            return findIndex(key, mix(key));
+        }
+
+        size_t findIndex(const K& key, const uint64_t hash) const {
+            if(_size == 0) return npos;
+
+            return probe(hash, [&](const size_t base) -> std::optional<size_t> {
+                const Group group(_ctrl + base);
+                for(auto match = group.match(h2(hash)); match; match.next()) {
+                    const auto index = base + match.lowest();
+                    if(Eq{}(_slots[index].key, key)) return index;
+                }
+                if(group.matchEmpty()) return npos;
+                return {};
+            });
+        }
+
+        // 调用前已经保证有空余的槽位
+        size_t findInsertIndex(const uint64_t hash) const {
+            return probe(hash, [&](const size_t base) -> std::optional<size_t> {
+                const auto match = Group(_ctrl + base).matchEmptyOrDeleted();
+                if(match) return base + match.lowest();
+                return {};
+            });
+        }
+
+        void rehash(const size_t capacity) {
+            auto* oldCtrl = _ctrl;
+            auto* oldSlots = _slots;
+            const auto oldCapacity = _capacity;
+
+            _ctrl = new int8_t[capacity];
+            std::memset(_ctrl, CTRL_EMPTY, capacity);
+            _slots = static_cast<Slot*>(::operator new(sizeof(Slot) * capacity, std::align_val_t{ alignof(Slot) }));
+            _capacity = capacity;
+            _deleted = 0;
+
+            for(size_t i = 0; i < oldCapacity; ++i) {
+                if(oldCtrl[i] < 0) continue;
+
+                const auto hash = mix(oldSlots[i].key);
+                const auto index = findInsertIndex(hash);
+                _ctrl[index] = h2(hash);
+                new(&_slots[index]) Slot{ std::move(oldSlots[i]) };
+                oldSlots[i].~Slot();
+            }
+
+            delete[] oldCtrl;
+            ::operator delete(oldSlots, std::align_val_t{ alignof(Slot) });
+        }
+
+        void destroy() noexcept {
+            for(size_t i = 0; i < _capacity; ++i) {
+                if(_ctrl[i] >= 0) _slots[i].~Slot();
+            }
+            delete[] _ctrl;
+            ::operator delete(_slots, std::align_val_t{ alignof(Slot) });
+        }
+    };
+}
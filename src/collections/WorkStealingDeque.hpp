@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024/9/2 下午8:12
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace Ciallang::Collections {
+    /**
+     * Chase-Lev 工作窃取双端队列
+     * 只有拥有者线程可以 push/pop (栈顶), 其他线程通过 steal 从栈底窃取
+     *
+     * 参考: Correct and Efficient Work-Stealing for Weak Memory Models (Lê et al. 2013)
+     */
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    class WorkStealingDeque {
+        struct Buffer {
+            explicit Buffer(const int64_t capacity) :
+                capacity(capacity),
+                data(std::make_unique<std::atomic<T>[]>(capacity)) {
+            }
+
+            T get(const int64_t index) const noexcept {
+                return data[index & (capacity - 1)].load(std::memory_order_relaxed);
+            }
+
+            void put(const int64_t index, T value) noexcept {
+                data[index & (capacity - 1)].store(value, std::memory_order_relaxed);
+            }
+
+            const int64_t capacity;
+            std::unique_ptr<std::atomic<T>[]> data;
+        };
+
+    public:
+        explicit WorkStealingDeque(const int64_t capacity = 1024) {
+            // 容量必须是 2 的幂
+            int64_t size = 1;
+            while(size < capacity) size <<= 1;
+
+            _buffers.push_back(std::make_unique<Buffer>(size));
+            _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // 仅拥有者线程调用
+        void push(T value) {
+            const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+            const int64_t top = _top.load(std::memory_order_acquire);
+            Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+
+            if(bottom - top > buffer->capacity - 1) {
+                buffer = grow(buffer, top, bottom);
+            }
+
+            buffer->put(bottom, value);
+            std::atomic_thread_fence(std::memory_order_release);
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // 仅拥有者线程调用
+        std::optional<T> pop() {
+            const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+            Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+            _bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = _top.load(std::memory_order_relaxed);
+
+            if(top > bottom) {
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+                return {};
+            }
+
+            T value = buffer->get(bottom);
+            if(top == bottom) {
+                // 最后一个元素, 和窃取者竞争
+                const bool won = _top.compare_exchange_strong(
+                    top, top + 1,
+                    std::memory_order_seq_cst,
+                    std::memory_order_relaxed
+                );
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+                if(!won) return {};
+            }
+            return value;
+        }
+
+        // 任意线程调用
+        std::optional<T> steal() {
+            int64_t top = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+            if(top >= bottom) return {};
+
+            const Buffer* buffer = _buffer.load(std::memory_order_acquire);
+            T value = buffer->get(top);
+            if(!_top.compare_exchange_strong(
+                top, top + 1,
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed
+            )) {
+                return {};
+            }
+            return value;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            const int64_t top = _top.load(std::memory_order_relaxed);
+            const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+            return top >= bottom;
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> _top{ 0 };
+        alignas(64) std::atomic<int64_t> _bottom{ 0 };
+        std::atomic<Buffer*> _buffer{ nullptr };
+
+        // 窃取者可能还在读旧的缓冲区, 扩容后旧缓冲区保留到析构
+        std::vector<std::unique_ptr<Buffer>> _buffers{};
+
+        Buffer* grow(const Buffer* old, const int64_t top, const int64_t bottom) {
+            auto buffer = std::make_unique<Buffer>(old->capacity << 1);
+            for(int64_t i = top; i < bottom; ++i) {
+                buffer->put(i, old->get(i));
+            }
+
+            _buffers.push_back(std::move(buffer));
+            Buffer* result = _buffers.back().get();
+            _buffer.store(result, std::memory_order_release);
+            return result;
+        }
+    };
+}
@@ -106,7 +106,51 @@ namespace Ciallang::Common {
         return _buffer.empty();
     }
 
+    bool SourceFile::buildLinesFast() {
+        const std::string_view text{ reinterpret_cast<const char *>(_buffer.data()), _buffer.size() };
+
+        // NUL, 中间的 BOM 和非法编码需要 next 报错, 交给逐字符的路径处理
+        if (text.find('\0') != std::string_view::npos
+            || text.find("\xef\xbb\xbf", 1) != std::string_view::npos
+            || !utf8Validate(text.data(), text.size())) {
+            return false;
+        }
+
+        uint32_t line = 0;
+        size_t lineStart = 0;
+        while (true) {
+            const auto newLine = text.find('\n', lineStart);
+            const auto end = newLine == std::string_view::npos ? text.size() : newLine;
+
+            // 和 next 一致: 开头的 BOM 和行尾 \r\n 中的 \r 不计入列数
+            auto columns = static_cast<uint32_t>(utf8Count(text.data() + lineStart, end - lineStart));
+            if (line == 0 && text.starts_with("\xef\xbb\xbf")) columns--;
+            if (newLine != std::string_view::npos && end > lineStart && text[end - 1] == '\r') columns--;
+
+            const auto it = _linesByIndexRange.insert(std::make_pair(
+                    std::make_pair(lineStart, end),
+                    SourceFileLineType{
+                            .end = end,
+                            .begin = lineStart,
+                            .line = line,
+                            .columns = columns
+                    }));
+            _linesByNumber.insert(std::make_pair(
+                    line,
+                    &it.first->second));
+
+            if (newLine == std::string_view::npos) break;
+            lineStart = newLine + 1;
+            line++;
+        }
+
+        seek(0);
+        return true;
+    }
+
     void SourceFile::buildLines(Result &r) {
+        if (buildLinesFast()) return;
+
         uint32_t line = 0;
         uint32_t columns = 0;
         size_t lineStart = 0;
@@ -171,15 +215,7 @@ namespace Ciallang::Common {
         _linesByNumber.clear();
         _linesByIndexRange.clear();
 
-        std::stringstream stream;
-        stream.unsetf(std::ios::skipws);
-        stream << buffer;
-        stream.seekg(0, std::ios::beg);
-
-        _buffer.reserve(buffer.length());
-        _buffer.insert(_buffer.begin(),
-                       std::istream_iterator<uint8_t>(stream),
-                       std::istream_iterator<uint8_t>());
+        _buffer.assign(buffer.begin(), buffer.end());
         buildLines(r);
 
         return true;
@@ -202,14 +238,11 @@ namespace Ciallang::Common {
                     std::ios::in | std::ios::binary
             }; file.is_open()) {
 
-            file.unsetf(std::ios::skipws);
             file.seekg(0, std::ios::end);
             const auto file_size = file.tellg();
             file.seekg(0, std::ios::beg);
-            _buffer.reserve(file_size);
-            _buffer.insert(_buffer.begin(),
-                           std::istream_iterator<uint8_t>(file),
-                           std::istream_iterator<uint8_t>());
+            _buffer.resize(static_cast<size_t>(file_size));
+            file.read(reinterpret_cast<char *>(_buffer.data()), file_size);
             buildLines(r);
         } else {
             r.error(
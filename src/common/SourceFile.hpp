@@ -95,6 +95,9 @@ namespace Ciallang::Common {
 
         void buildLines(Result &r);
 
+        // 整块校验后按 '\n' 切分, 不逐个解码码点; 可能出错时返回 false
+        bool buildLinesFast();
+
         size_t _index = 0;
         std::filesystem::path _path;
         std::vector<uint8_t> _buffer;
@@ -13,8 +13,23 @@
  */
 
 #include "UTF8.hpp"
+
+#include <bit>
 #include <utf8proc.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CIALLANG_UTF8_AVX2 1
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define CIALLANG_UTF8_SSE4 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CIALLANG_UTF8_SSE2 1
+#endif
+
 namespace Ciallang::Common {
 
     bool isRuneDigit(const int32_t r) {
@@ -99,26 +114,312 @@ namespace Ciallang::Common {
     }
 
     int64_t utf8Strlen(const std::string& str) {
-        int64_t len = 0;
-        auto p = str.data();
-        for(; *p; len++) {
-            const auto c = static_cast<uint8_t>(*p);
-
-            size_t cp_size;
-            if(c < 0x80)
-                cp_size = 1;
-            else if((c & 0xe0) == 0xc0)
-                cp_size = 2;
-            else if((c & 0xf0) == 0xe0)
-                cp_size = 3;
-            else if((c & 0xf8) == 0xf0)
-                cp_size = 4;
-            else
-                return -1;
-
-            p += cp_size;
-        }
-        return len;
+        if(!utf8Validate(str.data(), str.size())) return -1;
+        return static_cast<int64_t>(utf8Count(str.data(), str.size()));
+    }
+
+    static bool isAsciiWord(const uint8_t* s) {
+        uint64_t word;
+        std::memcpy(&word, s, sizeof(word));
+        return (word & 0x8080808080808080ull) == 0;
+    }
+
+    bool utf8ValidateScalar(const char* str, const size_t length) {
+        const auto* s = reinterpret_cast<const uint8_t*>(str);
+        size_t i = 0;
+        while(i < length) {
+            // 8 字节一组跳过 ASCII
+            if(i + 8 <= length && isAsciiWord(s + i)) {
+                i += 8;
+                continue;
+            }
+
+            const auto c = s[i];
+            if(c < 0x80) {
+                ++i;
+                continue;
+            }
+
+            const auto x = S_Utf8_First[c];
+            if(x >= 0xf0) return false;
+
+            const size_t size = x & 7;
+            if(length - i < size) return false;
+
+            const auto accept = S_Utf8AcceptRanges[x >> 4];
+            if(s[i + 1] < accept.low || accept.high < s[i + 1]) return false;
+
+            for(size_t k = 2; k < size; ++k) {
+                if((s[i + k] & 0xc0) != 0x80) return false;
+            }
+            i += size;
+        }
+        return true;
+    }
+
+    size_t utf8CountScalar(const char* str, const size_t length) {
+        size_t count = 0;
+        for(size_t i = 0; i < length; ++i) {
+            count += (static_cast<uint8_t>(str[i]) & 0xc0) != 0x80;
+        }
+        return count;
+    }
+
+#if defined(CIALLANG_UTF8_AVX2) || defined(CIALLANG_UTF8_SSE4)
+    /**
+     * 查表校验 (Keiser & Lemire, Validating UTF-8 In Less Than One Instruction Per Byte)
+     *
+     * 用前一个字节的高低半字节和当前字节的高半字节查三张表, 三者按位与不为 0 就是错误.
+     * 第三, 第四个字节的续字节由 must23 单独标出, 和 TWO_CONTS 异或抵消
+     */
+    namespace {
+        constexpr uint8_t TOO_SHORT = 1 << 0;
+        constexpr uint8_t TOO_LONG = 1 << 1;
+        constexpr uint8_t OVERLONG_3 = 1 << 2;
+        constexpr uint8_t TOO_LARGE = 1 << 3;
+        constexpr uint8_t SURROGATE = 1 << 4;
+        constexpr uint8_t OVERLONG_2 = 1 << 5;
+        constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+        constexpr uint8_t OVERLONG_4 = 1 << 6;
+        constexpr uint8_t TWO_CONTS = 1 << 7;
+        constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+        alignas(16) constexpr uint8_t S_Byte1High[16] = {
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2,
+            TOO_SHORT,
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+        };
+
+        alignas(16) constexpr uint8_t S_Byte1Low[16] = {
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+            CARRY | OVERLONG_2,
+            CARRY,
+            CARRY,
+            CARRY | TOO_LARGE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+        };
+
+        alignas(16) constexpr uint8_t S_Byte2High[16] = {
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        };
+    }
+#endif
+
+#ifdef CIALLANG_UTF8_AVX2
+    static bool utf8ValidateSimd(const uint8_t* s, const size_t length) {
+        const auto table = [](const uint8_t* bytes) {
+            return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(bytes)));
+        };
+        const __m256i byte1High = table(S_Byte1High);
+        const __m256i byte1Low = table(S_Byte1Low);
+        const __m256i byte2High = table(S_Byte2High);
+        const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+
+        // 最后三个字节是多字节序列的开头时, 需要下一块补全
+        const __m256i incompleteMax = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1)
+        );
+
+        __m256i error = _mm256_setzero_si256();
+        __m256i previous = _mm256_setzero_si256();
+        __m256i previousIncomplete = _mm256_setzero_si256();
+
+        const auto check = [&](const __m256i input) {
+            if(_mm256_movemask_epi8(input) == 0) {
+                error = _mm256_or_si256(error, previousIncomplete);
+                previousIncomplete = _mm256_setzero_si256();
+                previous = input;
+                return;
+            }
+
+            const __m256i shifted = _mm256_permute2x128_si256(previous, input, 0x21);
+            const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+            const __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+            const __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+
+            const __m256i special = _mm256_and_si256(
+                _mm256_and_si256(
+                    _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), lowNibble)),
+                    _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, lowNibble))
+                ),
+                _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), lowNibble))
+            );
+
+            const __m256i must23 = _mm256_and_si256(
+                _mm256_or_si256(
+                    _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80))),
+                    _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)))
+                ),
+                _mm256_set1_epi8(static_cast<char>(0x80))
+            );
+
+            error = _mm256_or_si256(error, _mm256_xor_si256(must23, special));
+            previousIncomplete = _mm256_subs_epu8(input, incompleteMax);
+            previous = input;
+        };
+
+        size_t i = 0;
+        for(; i + 32 <= length; i += 32) {
+            check(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)));
+        }
+
+        // 剩余部分补 0 凑成一块, 0 是 ASCII 不影响结果
+        if(i < length) {
+            alignas(32) uint8_t tail[32]{};
+            std::memcpy(tail, s + i, length - i);
+            check(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)));
+        }
+
+        error = _mm256_or_si256(error, previousIncomplete);
+        return _mm256_testz_si256(error, error);
+    }
+#elif defined(CIALLANG_UTF8_SSE4)
+    static bool utf8ValidateSimd(const uint8_t* s, const size_t length) {
+        const __m128i byte1High = _mm_load_si128(reinterpret_cast<const __m128i*>(S_Byte1High));
+        const __m128i byte1Low = _mm_load_si128(reinterpret_cast<const __m128i*>(S_Byte1Low));
+        const __m128i byte2High = _mm_load_si128(reinterpret_cast<const __m128i*>(S_Byte2High));
+        const __m128i lowNibble = _mm_set1_epi8(0x0f);
+
+        // 最后三个字节是多字节序列的开头时, 需要下一块补全
+        const __m128i incompleteMax = _mm_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1)
+        );
+
+        __m128i error = _mm_setzero_si128();
+        __m128i previous = _mm_setzero_si128();
+        __m128i previousIncomplete = _mm_setzero_si128();
+
+        const auto check = [&](const __m128i input) {
+            if(_mm_movemask_epi8(input) == 0) {
+                error = _mm_or_si128(error, previousIncomplete);
+                previousIncomplete = _mm_setzero_si128();
+                previous = input;
+                return;
+            }
+
+            const __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+            const __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+            const __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+
+            const __m128i special = _mm_and_si128(
+                _mm_and_si128(
+                    _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), lowNibble)),
+                    _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, lowNibble))
+                ),
+                _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), lowNibble))
+            );
+
+            const __m128i must23 = _mm_and_si128(
+                _mm_or_si128(
+                    _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xe0 - 0x80))),
+                    _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xf0 - 0x80)))
+                ),
+                _mm_set1_epi8(static_cast<char>(0x80))
+            );
+
+            error = _mm_or_si128(error, _mm_xor_si128(must23, special));
+            previousIncomplete = _mm_subs_epu8(input, incompleteMax);
+            previous = input;
+        };
+
+        size_t i = 0;
+        for(; i + 16 <= length; i += 16) {
+            check(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+        }
+
+        // 剩余部分补 0 凑成一块, 0 是 ASCII 不影响结果
+        if(i < length) {
+            alignas(16) uint8_t tail[16]{};
+            std::memcpy(tail, s + i, length - i);
+            check(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)));
+        }
+
+        error = _mm_or_si128(error, previousIncomplete);
+        return _mm_testz_si128(error, error);
+    }
+#endif
+
+    bool utf8Validate(const char* str, const size_t length) {
+#if defined(CIALLANG_UTF8_AVX2) || defined(CIALLANG_UTF8_SSE4)
+        return utf8ValidateSimd(reinterpret_cast<const uint8_t*>(str), length);
+#else
+        return utf8ValidateScalar(str, length);
+#endif
+    }
+
+#ifdef CIALLANG_UTF8_SSE2
+    // 块内非续字节 (不是 10xxxxxx) 的位掩码, 有符号比较下续字节是 [-128, -65]
+    static uint32_t leadMask(const char* str) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(block, _mm_set1_epi8(-65))));
+    }
+#endif
+
+    size_t utf8Count(const char* str, const size_t length) {
+        size_t count = 0;
+        size_t i = 0;
+
+#ifdef CIALLANG_UTF8_AVX2
+        for(; i + 32 <= length; i += 32) {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+            count += std::popcount(static_cast<uint32_t>(
+                _mm256_movemask_epi8(_mm256_cmpgt_epi8(block, _mm256_set1_epi8(-65)))
+            ));
+        }
+#endif
+#ifdef CIALLANG_UTF8_SSE2
+        for(; i + 16 <= length; i += 16) {
+            count += std::popcount(leadMask(str + i));
+        }
+#endif
+
+        return count + utf8CountScalar(str + i, length - i);
+    }
+
+    size_t utf8Offset(const char* str, const size_t length, size_t index) {
+        size_t i = 0;
+
+#ifdef CIALLANG_UTF8_SSE2
+        // 整块跳过, 目标码点落在块内时取第 index 个置位
+        for(; i + 16 <= length; i += 16) {
+            auto mask = leadMask(str + i);
+            const auto count = static_cast<size_t>(std::popcount(mask));
+            if(index >= count) {
+                index -= count;
+                continue;
+            }
+
+            for(; index > 0; --index) mask &= mask - 1;
+            return i + std::countr_zero(mask);
+        }
+#endif
+
+        for(; i < length; ++i) {
+            if((static_cast<uint8_t>(str[i]) & 0xc0) == 0x80) continue;
+            if(index-- == 0) return i;
+        }
+        return length;
     }
 
     CodePointType utf8Decode(const char* str, const size_t length) {
@@ -75,7 +75,22 @@ namespace Ciallang::Common {
 
     EncodedRuneType utf8Encode(int32_t r);
 
+    // 码点个数, 不是合法的 UTF-8 时返回 -1
     int64_t utf8Strlen(const string& str);
 
+    // 完整校验 UTF-8, 拒绝过长编码, 代理项和超过 U+10FFFF 的码点
+    bool utf8Validate(const char* str, size_t length);
+
+    // 码点个数, 输入必须是合法的 UTF-8
+    size_t utf8Count(const char* str, size_t length);
+
+    // 第 index 个码点开始的字节偏移, 超出末尾时返回 length
+    size_t utf8Offset(const char* str, size_t length, size_t index);
+
+    // 逐字节的实现, 用于测试和基准测试对照
+    bool utf8ValidateScalar(const char* str, size_t length);
+
+    size_t utf8CountScalar(const char* str, size_t length);
+
     CodePointType utf8Decode(const char* str, size_t length);
 };
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2024/10/21 下午3:40
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include <span>
+
+#include "types/TjsNativeFunction.hpp"
+#include "types/TjsOctet.hpp"
+#include "types/TjsString.hpp"
+
+namespace Ciallang::Core {
+    /**
+     * 编译期生成原生函数的参数拆箱和结果装箱
+     *
+     * static TjsInteger add(TjsInteger a, TjsInteger b) { return a + b; }
+     * static const auto S_AddFunction = bindNative<&add>("add");
+     *
+     * arity 等于形参个数, 参数类型不符时抛出 logic_error
+     */
+    [[noreturn]] inline void argumentError(const size_t index, const std::string_view expected, const TjsValue& value) {
+        throw std::logic_error(fmt::format("argument {} expects {}, but is {}", index + 1, expected, value.name()));
+    }
+
+    template <typename T>
+    struct TjsUnbox;
+
+    // 原样传递, 由函数自己检查
+    template <>
+    struct TjsUnbox<TjsValue> {
+        static const TjsValue& unbox(const TjsValue& value, size_t) {
+            return value;
+        }
+    };
+
+    template <>
+    struct TjsUnbox<bool> {
+        static bool unbox(const TjsValue& value, size_t) {
+            return value.asBool();
+        }
+    };
+
+    template <std::signed_integral T>
+    struct TjsUnbox<T> {
+        static T unbox(const TjsValue& value, const size_t index) {
+            if(!value.isInteger()) argumentError(index, "integer", value);
+            return static_cast<T>(value.asInteger());
+        }
+    };
+
+    // 下标和长度
+    template <std::unsigned_integral T>
+        requires (!std::same_as<T, bool>)
+    struct TjsUnbox<T> {
+        static T unbox(const TjsValue& value, const size_t index) {
+            if(!value.isInteger() || value.asInteger() < 0) argumentError(index, "non-negative integer", value);
+            return static_cast<T>(value.asInteger());
+        }
+    };
+
+    // 整数可以隐式当作实数
+    template <std::floating_point T>
+    struct TjsUnbox<T> {
+        static T unbox(const TjsValue& value, const size_t index) {
+            if(value.isReal()) return static_cast<T>(value.asReal());
+            if(value.isInteger()) return static_cast<T>(value.asInteger());
+            argumentError(index, "real", value);
+        }
+    };
+
+    // 指向寄存器里的字符串, 只在调用期间有效
+    template <>
+    struct TjsUnbox<std::string_view> {
+        static std::string_view unbox(const TjsValue& value, const size_t index) {
+            if(!value.isString()) argumentError(index, "string", value);
+            return value.asString();
+        }
+    };
+
+    template <>
+    struct TjsUnbox<std::string> {
+        static std::string unbox(const TjsValue& value, const size_t index) {
+            return std::string{ TjsUnbox<std::string_view>::unbox(value, index) };
+        }
+    };
+
+    // 借用寄存器持有的引用
+    template <>
+    struct TjsUnbox<TjsOctet*> {
+        static TjsOctet* unbox(const TjsValue& value, const size_t index) {
+            if(!value.isOctet()) argumentError(index, "octet", value);
+            return value.asOctet();
+        }
+    };
+
+    template <typename T>
+        requires std::is_base_of_v<TjsObject, T>
+    struct TjsUnbox<T*> {
+        static T* unbox(const TjsValue& value, const size_t index) {
+            if(!value.isObject()) argumentError(index, "object", value);
+
+            auto* object = dynamic_cast<T*>(value.asObject());
+            if(!object) {
+                throw std::logic_error(fmt::format(
+                    "argument {} can't be {}", index + 1, value.asObject()->name()
+                ));
+            }
+            return object;
+        }
+    };
+
+    template <typename T>
+    struct TjsBox;
+
+    template <>
+    struct TjsBox<TjsValue> {
+        static TjsValue box(TjsValue&& value) {
+            return std::move(value);
+        }
+    };
+
+    // 没有布尔类型, 和比较运算一样用 0 和 1
+    template <>
+    struct TjsBox<bool> {
+        static TjsValue box(const bool value) {
+            return TjsValue{ TjsInteger{ value ? 1 : 0 } };
+        }
+    };
+
+    template <std::integral T>
+        requires (!std::same_as<T, bool>)
+    struct TjsBox<T> {
+        static TjsValue box(const T value) {
+            return TjsValue{ static_cast<TjsInteger>(value) };
+        }
+    };
+
+    template <std::floating_point T>
+    struct TjsBox<T> {
+        static TjsValue box(const T value) {
+            return TjsValue{ static_cast<TjsReal>(value) };
+        }
+    };
+
+    template <>
+    struct TjsBox<std::string> {
+        static TjsValue box(std::string&& value) {
+            return TjsValue{ std::move(value) };
+        }
+    };
+
+    template <>
+    struct TjsBox<std::string_view> {
+        static TjsValue box(const std::string_view value) {
+            return TjsValue{ std::string{ value } };
+        }
+    };
+
+    // 接管返回的引用
+    template <>
+    struct TjsBox<TjsOctet*> {
+        static TjsValue box(TjsOctet* value) {
+            return TjsValue{ value };
+        }
+    };
+
+    template <>
+    struct TjsBox<TjsString*> {
+        static TjsValue box(TjsString* value) {
+            return TjsValue{ value };
+        }
+    };
+
+    template <typename T>
+        requires std::is_base_of_v<TjsObject, T>
+    struct TjsBox<T> {
+        static TjsValue box(const T& value) {
+            return TjsValue{ value };
+        }
+    };
+
+    template <auto Function>
+    struct TjsNativeBinding;
+
+    template <typename R, typename... Args, R (*Function)(Args...)>
+    struct TjsNativeBinding<Function> {
+        static constexpr size_t arity = sizeof...(Args);
+
+        static void call(Bytecode::Interpreter&, const std::span<const TjsValue> arguments, TjsValue* ret, void*) {
+            invoke(arguments, ret, std::index_sequence_for<Args...>{});
+        }
+
+    private:
+        template <size_t... I>
+        static void invoke(const std::span<const TjsValue> arguments, TjsValue* ret, std::index_sequence<I...>) {
+            if constexpr(std::is_void_v<R>) {
+                Function(TjsUnbox<std::remove_cvref_t<Args>>::unbox(arguments[I], I)...);
+            } else {
+                *ret = TjsBox<std::remove_cvref_t<R>>::box(
+                    Function(TjsUnbox<std::remove_cvref_t<Args>>::unbox(arguments[I], I)...)
+                );
+            }
+        }
+    };
+
+    template <auto Function>
+    TjsNativeFunction bindNative(std::string name) {
+        using Binding = TjsNativeBinding<Function>;
+        return TjsNativeFunction{ &Binding::call, Binding::arity, std::move(name) };
+    }
+}
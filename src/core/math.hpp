@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024/10/23 上午10:15
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "core/bind.hpp"
+
+namespace Ciallang::Core {
+    // 还没有成员调用语法, Math.abs/min/max 先以 mathAbs/mathMin/mathMax 提供
+    // 字节码生成器会把未被覆盖的调用直接编译为 abs/min/max 指令, 两者共用下面的实现.
+    // 指令按回调地址判断全局是否仍是内建函数, 所以这里用 inline, 每个翻译单元的回调都是同一个
+
+    inline TjsReal mathNumber(const TjsValue& value) {
+        if(value.isInteger()) return static_cast<TjsReal>(value.asInteger());
+        if(value.isReal()) return value.asReal();
+        throw std::logic_error("expects number, but is " + value.name());
+    }
+
+    // 整数保持整数, 只有最小值的绝对值超出整数范围, 转为实数
+    inline TjsValue mathAbs(const TjsValue& value) {
+        if(value.isInteger()) {
+            const auto integer = value.asInteger();
+            if(integer == std::numeric_limits<TjsInteger>::min()) {
+                return TjsValue{ -static_cast<TjsReal>(integer) };
+            }
+            return TjsValue{ integer < 0 ? -integer : integer };
+        }
+        return TjsValue{ std::fabs(mathNumber(value)) };
+    }
+
+    // 相等时返回第一个参数, 结果保留原来的类型
+    inline TjsValue mathMin(const TjsValue& a, const TjsValue& b) {
+        return mathNumber(b) < mathNumber(a) ? b : a;
+    }
+
+    inline TjsValue mathMax(const TjsValue& a, const TjsValue& b) {
+        return mathNumber(b) > mathNumber(a) ? b : a;
+    }
+
+    static const auto S_MathAbsFunction = bindNative<&mathAbs>("mathAbs");
+    static const auto S_MathMinFunction = bindNative<&mathMin>("mathMin");
+    static const auto S_MathMaxFunction = bindNative<&mathMax>("mathMax");
+}
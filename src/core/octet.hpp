@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024/11/8 下午3:20
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "core/bind.hpp"
+#include "types/TjsOctet.hpp"
+
+namespace Ciallang::Core {
+    static size_t octetLength(TjsOctet* octet) {
+        return octet->size();
+    }
+
+    // 切片共享原来的缓冲区, 不拷贝内容
+    static TjsOctet* octetSlice(TjsOctet* octet, const size_t offset, const size_t length) {
+        return TjsOctet::slice(octet, offset, length);
+    }
+
+    // 找不到时返回 -1
+    static TjsInteger octetFind(TjsOctet* octet, TjsOctet* pattern) {
+        const auto index = octet->find(pattern->bytes());
+        return index == TjsOctet::npos ? TjsInteger{ -1 } : static_cast<TjsInteger>(index);
+    }
+
+    static std::string octetToHex(TjsOctet* octet) {
+        return octet->toHex();
+    }
+
+    static std::string octetToBase64(TjsOctet* octet) {
+        return octet->toBase64();
+    }
+
+    static const auto S_OctetLengthFunction = bindNative<&octetLength>("octetLength");
+    static const auto S_OctetSliceFunction = bindNative<&octetSlice>("octetSlice");
+    static const auto S_OctetFindFunction = bindNative<&octetFind>("octetFind");
+    static const auto S_OctetToHexFunction = bindNative<&octetToHex>("octetToHex");
+    static const auto S_OctetToBase64Function = bindNative<&octetToBase64>("octetToBase64");
+}
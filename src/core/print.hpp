@@ -15,20 +15,18 @@
 
 #include "pch.h"
 
-#include "types/TjsNativeFunction.hpp"
+#include "core/bind.hpp"
 
 namespace Ciallang::Core {
-    static const auto S_PrintFunction = TjsNativeFunction{
-            [](const TjsValue* values) {
-                fmt::print("{}", *values);
-            },
-            1, "print"
-    };
+    // print/println 指令按回调地址识别内建函数, 用 inline 保证所有翻译单元的回调相同
+    inline void printValue(const TjsValue& value) {
+        fmt::print("{}", value);
+    }
 
-    static const auto S_PrintlnFunction = TjsNativeFunction{
-            [](const TjsValue* values) {
-                fmt::println("{}", *values);
-            },
-            1, "println"
-    };
+    inline void printlnValue(const TjsValue& value) {
+        fmt::println("{}", value);
+    }
+
+    static const auto S_PrintFunction = bindNative<&printValue>("print");
+    static const auto S_PrintlnFunction = bindNative<&printlnValue>("println");
 }
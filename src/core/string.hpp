@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2024/11/5 下午4:32
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include <utf8proc.h>
+
+#include "common/UTF8.hpp"
+#include "core/bind.hpp"
+#include "types/TjsArray.hpp"
+#include "types/TjsString.hpp"
+#include "types/TjsStringBuilder.hpp"
+
+namespace Ciallang::Core {
+    // 还没有成员调用语法, 先以普通函数的形式提供
+    static TjsStringBuilder stringBuilder() {
+        return TjsStringBuilder{};
+    }
+
+    static void stringBuilderAppend(TjsStringBuilder* builder, const TjsValue& value) {
+        builder->append(value);
+    }
+
+    static TjsValue stringBuilderToString(TjsStringBuilder* builder) {
+        return builder->toString();
+    }
+
+    static const auto S_StringBuilderFunction = bindNative<&stringBuilder>("StringBuilder");
+    static const auto S_StringBuilderAppendFunction = bindNative<&stringBuilderAppend>("sbAppend");
+    static const auto S_StringBuilderToStringFunction = bindNative<&stringBuilderToString>("sbToString");
+
+    // 字符串函数的下标和长度都按码点计算
+
+    static std::string_view stringView(const TjsValue& value) {
+        if(!value.isString()) {
+            throw std::logic_error("expects string, but is " + value.name());
+        }
+        return value.asString();
+    }
+
+    // 按字节取子串: 整个字符串时共享原值, 长串共享原来的缓冲区, 短串存放在值里面
+    static TjsValue substringValue(const TjsValue& value, const size_t offset, const size_t length) {
+        const auto view = value.asString();
+        if(offset == 0 && length >= view.size()) return value;
+        if(auto* string = value.asTjsString(); string && length > TjsValue::SMALL_STRING_CAPACITY) {
+            return TjsValue{ TjsString::substring(string, offset, length) };
+        }
+        return TjsValue{ std::string{ view.substr(offset, length) } };
+    }
+
+    static size_t stringLength(const std::string_view view) {
+        return Common::utf8Count(view.data(), view.size());
+    }
+
+    // 找不到时返回 -1
+    static TjsInteger stringIndexOf(const std::string_view view, const std::string_view search) {
+        const auto position = view.find(search);
+        if(position == std::string_view::npos) return -1;
+        return static_cast<TjsInteger>(Common::utf8Count(view.data(), position));
+    }
+
+    static TjsValue stringSubstring(const TjsValue& value, const size_t start, const size_t length) {
+        const auto view = stringView(value);
+        const auto begin = Common::utf8Offset(view.data(), view.size(), start);
+        const auto end = begin + Common::utf8Offset(view.data() + begin, view.size() - begin, length);
+        return substringValue(value, begin, end - begin);
+    }
+
+    // 分隔符为空字符串时按码点拆分
+    static TjsValue stringSplit(const TjsValue& value, const std::string_view separator) {
+        const auto view = stringView(value);
+
+        TjsValue result{ TjsArray{} };
+        auto* array = static_cast<TjsArray*>(result.asObject());
+        if(separator.empty()) {
+            for(size_t begin = 0; begin < view.size();) {
+                const auto width = Common::utf8Decode(view.data() + begin, view.size() - begin).width;
+                array->push(substringValue(value, begin, width));
+                begin += width;
+            }
+            return result;
+        }
+
+        size_t begin = 0;
+        for(auto position = view.find(separator); position != std::string_view::npos;
+            position = view.find(separator, begin)) {
+            array->push(substringValue(value, begin, position - begin));
+            begin = position + separator.size();
+        }
+        array->push(substringValue(value, begin, view.size() - begin));
+        return result;
+    }
+
+    // 替换所有出现的位置
+    static TjsValue stringReplace(const TjsValue& value, const std::string_view from, const std::string_view to) {
+        const auto view = stringView(value);
+
+        auto position = from.empty() ? std::string_view::npos : view.find(from);
+        if(position == std::string_view::npos) return value;
+
+        std::string result{};
+        result.reserve(view.size());
+        size_t begin = 0;
+        for(; position != std::string_view::npos; position = view.find(from, begin)) {
+            result.append(view.substr(begin, position - begin)).append(to);
+            begin = position + from.size();
+        }
+        result.append(view.substr(begin));
+        return TjsValue{ std::move(result) };
+    }
+
+    static TjsValue stringTrim(const TjsValue& value) {
+        const auto view = stringView(value);
+        const auto begin = view.find_first_not_of(" \t\n\r");
+        if(begin == std::string_view::npos) return TjsValue{ std::string{} };
+
+        const auto end = view.find_last_not_of(" \t\n\r") + 1;
+        return substringValue(value, begin, end - begin);
+    }
+
+    // 纯 ASCII 直接逐字节转换, 其他码点交给 utf8proc
+    template <int32_t (*Convert)(int32_t), char First, char Last>
+    static std::string convertCase(const std::string_view view) {
+        std::string result{};
+        result.reserve(view.size());
+        for(size_t i = 0; i < view.size();) {
+            const auto ch = view[i];
+            if(static_cast<uint8_t>(ch) < 0x80) {
+                result.push_back(ch >= First && ch <= Last ? static_cast<char>(ch ^ 0x20) : ch);
+                ++i;
+                continue;
+            }
+
+            const auto cp = Common::utf8Decode(view.data() + i, view.size() - i);
+            const auto encoded = Common::utf8Encode(Convert(cp.value));
+            result.append(reinterpret_cast<const char*>(encoded.data), encoded.width);
+            i += cp.width;
+        }
+        return result;
+    }
+
+    static const auto S_StringLengthFunction = bindNative<&stringLength>("strLength");
+    static const auto S_StringIndexOfFunction = bindNative<&stringIndexOf>("strIndexOf");
+    static const auto S_StringSubstringFunction = bindNative<&stringSubstring>("strSubstring");
+    static const auto S_StringSplitFunction = bindNative<&stringSplit>("strSplit");
+    static const auto S_StringReplaceFunction = bindNative<&stringReplace>("strReplace");
+    static const auto S_StringTrimFunction = bindNative<&stringTrim>("strTrim");
+    static const auto S_StringToUpperFunction = bindNative<&convertCase<utf8proc_toupper, 'a', 'z'>>("strToUpper");
+    static const auto S_StringToLowerFunction = bindNative<&convertCase<utf8proc_tolower, 'A', 'Z'>>("strToLower");
+}
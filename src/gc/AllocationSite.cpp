@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024/9/4 下午8:26
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "AllocationSite.hpp"
+
+namespace Ciallang::GC {
+    AllocationSite::AllocationSite(const char* name) : _name(name) {
+        std::lock_guard lock{ registryLock() };
+        registry().push_back(this);
+    }
+
+    AllocationSite::~AllocationSite() {
+        std::lock_guard lock{ registryLock() };
+        std::erase(registry(), this);
+    }
+
+    void AllocationSite::decide() {
+        const size_t allocated = _allocated.load(std::memory_order_relaxed);
+        if(allocated < PRETENURE_MIN_ALLOCATIONS) return;
+
+        const size_t survived = _survived.exchange(0, std::memory_order_relaxed);
+        _allocated.fetch_sub(allocated, std::memory_order_relaxed);
+
+        if(!tenured() && static_cast<double>(survived) >= static_cast<double>(allocated) * PRETENURE_SURVIVAL_RATE) {
+            tenured(true);
+            LOG(INFO) << "Pretenure allocation site: " << _name;
+        }
+    }
+
+    void AllocationSite::decideAll() {
+        std::lock_guard lock{ registryLock() };
+        for(auto* site : registry()) {
+            site->decide();
+        }
+    }
+
+    std::mutex& AllocationSite::registryLock() {
+        static std::mutex lock{};
+        return lock;
+    }
+
+    std::vector<AllocationSite*>& AllocationSite::registry() {
+        static std::vector<AllocationSite*> sites{};
+        return sites;
+    }
+}
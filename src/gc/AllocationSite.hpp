@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024/9/4 下午8:26
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+namespace Ciallang::GC {
+    // 至少分配这么多次之后才根据存活率做决定
+    static constexpr size_t PRETENURE_MIN_ALLOCATIONS = 100;
+
+    // 一次 minor GC 中存活比例达到这个值的分配点改为直接在老年代分配
+    static constexpr double PRETENURE_SURVIVAL_RATE = 0.85;
+
+    /**
+     * 分配点, 通常是调用处的一个 static 变量:
+     *
+     *     static AllocationSite site{ "BytecodeGen::function" };
+     *     auto* fun = gc.allocate<TjsFunction>(site, ...);
+     *
+     * 新生代中通过分配点分配的对象后面紧跟一个 AllocationMemento,
+     * minor GC 复制 age 为 0 的对象时通过它找到分配点并记录存活
+     */
+    class AllocationSite {
+    public:
+        explicit AllocationSite(const char* name);
+
+        ~AllocationSite();
+
+        AllocationSite(const AllocationSite&) = delete;
+        AllocationSite& operator=(const AllocationSite&) = delete;
+
+        [[nodiscard]] const char* name() const noexcept { return _name; }
+
+        [[nodiscard]] bool tenured() const noexcept { return _tenured.load(std::memory_order_relaxed); }
+        void tenured(const bool tenured) noexcept { _tenured.store(tenured, std::memory_order_relaxed); }
+
+        void recordAllocation() noexcept { _allocated.fetch_add(1, std::memory_order_relaxed); }
+        void recordSurvivor() noexcept { _survived.fetch_add(1, std::memory_order_relaxed); }
+
+        [[nodiscard]] size_t allocated() const noexcept { return _allocated.load(std::memory_order_relaxed); }
+        [[nodiscard]] size_t survived() const noexcept { return _survived.load(std::memory_order_relaxed); }
+
+        // 根据上一次决定以来的存活率决定是否改为老年代分配, 样本足够时清零计数
+        void decide();
+
+        // minor GC 结束后对所有分配点做决定
+        static void decideAll();
+
+    private:
+        const char* _name;
+
+        std::atomic<size_t> _allocated{};
+        std::atomic<size_t> _survived{};
+        std::atomic<bool> _tenured{};
+
+        static std::mutex& registryLock();
+
+        static std::vector<AllocationSite*>& registry();
+    };
+
+    struct AllocationMemento {
+        static constexpr uint64_t MAGIC = 0x4D454D454E544F21; // "MEMENTO!"
+
+        uint64_t magic{ MAGIC };
+        AllocationSite* site{ nullptr };
+    };
+}
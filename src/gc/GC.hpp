@@ -16,26 +16,72 @@
 #include "pch.h"
 
 namespace Ciallang::GC {
+    class GCObject;
+
+    // 访问对象中的一个引用字段, 移动对象的回收器可以通过引用直接改写字段
+    using FieldVisitor = std::function<void(GCObject*&)>;
+
     /**
      * GC will not call destructor method.
      * all fields must manage for gc. don't memory manage for self
+     *
+     * 持有本地资源 (文件句柄, 缓冲区) 的对象通过 registerFinalizer 注册后,
+     * 死亡时会在安全点调用一次 finalize
      */
     class GCObject {
     public:
+        GCObject() = default;
+
+        // 标记位是原子的, 需要手动复制
+        GCObject(const GCObject& other) noexcept :
+            _age(other._age),
+            _forwarding(other._forwarding),
+            _remembered(other._remembered),
+            _marked(other.marked()) {
+        }
+
+        GCObject& operator=(const GCObject& other) noexcept {
+            if(this == &other) return *this;
+
+            _age = other._age;
+            _forwarding = other._forwarding;
+            _remembered = other._remembered;
+            marked(other.marked());
+            return *this;
+        }
+
         bool remembered() const noexcept { return _remembered; }
         void remembered(const bool remembered) noexcept { _remembered = remembered; }
 
+        // 永久区的对象, 回收器不会标记, 扫描和移动它
+        bool perm() const noexcept { return _perm; }
+        void perm(const bool perm) noexcept { _perm = perm; }
+
         size_t age() const noexcept { return _age; }
         void age(const size_t age) noexcept { _age = age; }
         void ageIncrement() noexcept { _age++; }
 
-        bool forwarded() const noexcept { return _forwarded; }
-        void forwarded(const bool forwarded) noexcept { _forwarded = forwarded; }
+        // 对象被移动后, 旧的副本记录新地址, 其他引用据此更新
+        bool forwarded() const noexcept { return _forwarding != nullptr; }
+        GCObject* forwarding() const noexcept { return _forwarding; }
+        void forwardTo(GCObject* forwarding) noexcept { _forwarding = forwarding; }
 
-        bool marked() const noexcept { return _marked; }
-        void marked(const bool marked) noexcept { _marked = marked; }
+        bool marked() const noexcept { return _marked.load(std::memory_order_relaxed); }
+        void marked(const bool marked) noexcept { _marked.store(marked, std::memory_order_relaxed); }
 
-        virtual std::optional<std::vector<GCObject*>> getFields() const = 0;
+        // 并行标记时多个线程可能同时标记同一个对象, 只有一个线程会成功
+        bool tryMark() noexcept {
+            return !_marked.load(std::memory_order_relaxed)
+                   && !_marked.exchange(true, std::memory_order_relaxed);
+        }
+
+        // 遍历所有引用字段, 没有引用字段的对象不需要重写
+        virtual void trace(const FieldVisitor&) {
+        }
+
+        // 只应该释放本地资源, 不能在 GC 堆上分配对象
+        virtual void finalize() {
+        }
 
         virtual GCObject* copyTo(uint8_t*) = 0;
 
@@ -43,14 +89,28 @@ namespace Ciallang::GC {
 
         virtual ~GCObject() = default;
 
-    private:
-        bool _remembered{};
+    protected:
+        // 子类的字段类型是 T*, 转成 GCObject*& 交给 visitor
+        template <typename T>
+        static void traceField(const FieldVisitor& visitor, T*& field) {
+            static_assert(std::is_base_of_v<GCObject, T>);
+
+            GCObject* ref = field;
+            visitor(ref);
+            field = static_cast<T*>(ref);
+        }
 
+    private:
         size_t _age{};
 
-        bool _forwarded{};
+        GCObject* _forwarding{ nullptr };
+
+        bool _remembered{};
+
+        // 复制出的对象不在永久区, 不复制这一位
+        bool _perm{};
 
-        bool _marked{};
+        std::atomic<bool> _marked{};
     };
 
     using Roots = std::vector<GCObject*>;
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2024/9/2 下午9:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#include "GCFlags.hpp"
+
+DEFINE_uint32(gc_mark_threads, 1, "number of threads used by the old generation parallel marker");
+
+DEFINE_bool(gc_concurrent_sweep, false, "sweep the old generation on a background thread");
+
+DEFINE_double(gc_compact_threshold, 0.0, "compact the old generation when its fragmentation reaches this ratio, 0 disables compaction");
+
+DEFINE_double(gc_heap_grow_occupancy, 0.7, "grow the old generation when this ratio of its cells is live after marking, 0 grows only when allocation fails");
+
+DEFINE_uint64(gc_max_heap_size, 0, "maximum heap size in bytes, 0 means unlimited");
+
+DEFINE_uint32(gc_new_ratio, 2, "tenths of the heap reserved for the young generation");
+
+DEFINE_uint32(gc_survivor_ratio, 8, "ratio of eden to a single survivor space");
+
+DEFINE_bool(gc_adaptive_nursery, true, "resize eden according to the minor GC survival rate");
+
+DEFINE_double(gc_target_survival_rate, 0.1, "survival rate the adaptive nursery sizing aims for");
+
+DEFINE_string(gc_trace_file, "", "write GC events to this file in Chrome trace event format");
+
+DEFINE_bool(gc_pretenuring, true, "allocate objects from allocation sites with a high survival rate directly in the old generation");
+
+DEFINE_bool(gc_torture, false, "collect on every allocation to shake out missing roots and write barriers, very slow");
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2024/9/2 下午9:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include <gflags/gflags.h>
+
+// 并行标记的线程数, 1 表示在当前线程标记
+DECLARE_uint32(gc_mark_threads);
+
+// 是否在后台线程中清除老年代
+DECLARE_bool(gc_concurrent_sweep);
+
+// 老年代碎片率达到这个值时整理, 0 表示从不整理
+DECLARE_double(gc_compact_threshold);
+
+// 老年代标记后存活 cell 的比例达到这个值时扩容, 0 表示只在分配失败时扩容
+DECLARE_double(gc_heap_grow_occupancy);
+
+// 堆的最大字节数, 0 表示不限制
+DECLARE_uint64(gc_max_heap_size);
+
+// 新生代占整个堆的十分之几
+DECLARE_uint32(gc_new_ratio);
+
+// Eden 与单个 survivor 区的比例
+DECLARE_uint32(gc_survivor_ratio);
+
+// 是否根据 minor GC 的存活率调整 eden 大小
+DECLARE_bool(gc_adaptive_nursery);
+
+// 调整 eden 大小时的目标存活率
+DECLARE_double(gc_target_survival_rate);
+
+// GC 事件的 Chrome trace 输出文件, 为空时不记录
+DECLARE_string(gc_trace_file);
+
+// 是否根据分配点的存活率把对象直接分配到老年代
+DECLARE_bool(gc_pretenuring);
+
+// 每次分配都执行一次回收, 用于找出遗漏的根和写屏障
+DECLARE_bool(gc_torture);
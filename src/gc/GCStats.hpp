@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024/9/3 下午7:41
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+namespace Ciallang::GC {
+    struct PauseStats {
+        size_t count{};
+        std::chrono::nanoseconds total{};
+        std::chrono::nanoseconds max{};
+
+        void record(const std::chrono::nanoseconds pause) noexcept {
+            ++count;
+            total += pause;
+            max = std::max(max, pause);
+        }
+    };
+
+    /**
+     * GC 统计信息的快照, 由 Generational::stats 生成.
+     * 没有 last 前缀的字节数和次数都是从堆创建开始累计的
+     */
+    struct GCStats {
+        PauseStats minorPause{};
+        PauseStats markPause{};
+        PauseStats sweepPause{};
+        PauseStats compactPause{};
+
+        // 完成的老年代标记次数
+        size_t markCycles{};
+
+        // 新生代
+        size_t collectedBytes{};
+        size_t survivedBytes{};
+        size_t promotedBytes{};
+        size_t youngFreedBytes{};
+        // 通过分配点直接在老年代分配的字节数
+        size_t pretenuredBytes{};
+
+        // 老年代
+        size_t oldFreedBytes{};
+        size_t oldLiveBytes{};
+        size_t oldCapacity{};
+
+        // 永久区 (可能与其他堆共享)
+        size_t permBytes{};
+
+        // 弱引用和终结
+        size_t weakRefs{};
+        size_t clearedWeakRefs{};
+        size_t pendingFinalizers{};
+        size_t finalizedObjects{};
+
+        // 最近一次 minor GC
+        size_t lastCollectedBytes{};
+        size_t lastSurvivedBytes{};
+        size_t lastPromotedBytes{};
+        double lastSurvivalRate{};
+
+        // 存活率的移动平均
+        double survivalRate{};
+
+        size_t rememberedSetSize{};
+        size_t edenLimit{};
+    };
+}
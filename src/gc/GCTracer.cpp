@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024/9/3 下午7:41
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "GCTracer.hpp"
+
+namespace Ciallang::GC {
+    // trace 查看器用 JavaScript 的 number 解析 tid, 不能直接用 std::thread::id 的哈希值
+    static size_t currentThreadId() {
+        static std::atomic<size_t> nextId{ 1 };
+        thread_local const size_t id = nextId.fetch_add(1);
+        return id;
+    }
+
+    void GCTracer::complete(const char* name,
+                            const Clock::time_point begin,
+                            const Clock::time_point end,
+                            Args&& args) {
+        const size_t tid = currentThreadId();
+
+        std::lock_guard lock{ _lock };
+        _events.push_back({ name, begin, end - begin, tid, std::move(args) });
+    }
+
+    std::vector<GCTracer::Clock::duration> GCTracer::durations() const {
+        std::lock_guard lock{ _lock };
+
+        std::vector<Clock::duration> durations{};
+        durations.reserve(_events.size());
+        for(const auto& event : _events) {
+            durations.push_back(event.duration);
+        }
+        return durations;
+    }
+
+    void GCTracer::write(std::ostream& out) const {
+        using Micros = std::chrono::duration<double, std::micro>;
+
+        std::lock_guard lock{ _lock };
+
+        out << R"({"traceEvents":[)";
+        for(size_t i = 0; i < _events.size(); ++i) {
+            const auto& event = _events[i];
+
+            out << (i == 0 ? "\n" : ",\n");
+            out << fmt::format(
+                R"({{"name":"{}","cat":"gc","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":1,"tid":{},"args":{{)",
+                event.name,
+                Micros{ event.begin - _origin }.count(),
+                Micros{ event.duration }.count(),
+                event.tid
+            );
+
+            for(size_t j = 0; j < event.args.size(); ++j) {
+                if(j > 0) out << ',';
+                out << fmt::format(R"("{}":{})", event.args[j].first, event.args[j].second);
+            }
+            out << "}}";
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+    bool GCTracer::writeFile(const std::filesystem::path& path) const {
+        std::ofstream out{ path };
+        if(!out) {
+            LOG(ERROR) << "Open GC trace file failed: " << path;
+            return false;
+        }
+
+        write(out);
+        return true;
+    }
+}
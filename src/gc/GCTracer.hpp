@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024/9/3 下午7:41
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+namespace Ciallang::GC {
+    /**
+     * 记录 GC 事件, 输出为 Chrome trace event 格式的 JSON,
+     * 可以在 chrome://tracing 或者 Perfetto 中按时间线查看
+     */
+    class GCTracer {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Args = std::vector<std::pair<const char*, size_t>>;
+
+        GCTracer() : _origin(Clock::now()) {
+        }
+
+        // 记录一个完整的事件 (ph = "X")
+        void complete(const char* name, Clock::time_point begin, Clock::time_point end, Args&& args = {});
+
+        void write(std::ostream& out) const;
+
+        bool writeFile(const std::filesystem::path& path) const;
+
+        // 所有事件的持续时间, 按记录顺序
+        [[nodiscard]] std::vector<Clock::duration> durations() const;
+
+        [[nodiscard]] size_t eventCount() const {
+            std::lock_guard lock{ _lock };
+            return _events.size();
+        }
+
+    private:
+        struct Event {
+            const char* name;
+            Clock::time_point begin;
+            Clock::duration duration;
+            size_t tid;
+            Args args;
+        };
+
+        Clock::time_point _origin;
+
+        mutable std::mutex _lock{};
+        std::vector<Event> _events{};
+    };
+}
@@ -17,12 +17,20 @@
 
 namespace Ciallang::GC {
     Generational::Generational(
-        const size_t size
-    ) : _heap(static_cast<uint8_t*>(malloc(size))),
+        const size_t size,
+        std::shared_ptr<PermSpace> permSpace
+    ) : _permSpace(permSpace ? std::move(permSpace) : std::make_shared<PermSpace>()),
+        _heap(static_cast<uint8_t*>(malloc(size))),
         _heapSize(size) {
-        size_t newSize = size / 10 * NEW_RATIO;
-        _edenSize = newSize / 10 * SURVIVOR_RATIO;
-        _survivorSize = newSize / 10;
+        CHECK(FLAGS_gc_new_ratio < 10) << "--gc_new_ratio must be less than 10";
+
+        // 对齐后老年代的 cell 和新生代的对象地址都是对齐的
+        size_t newSize = alignDown(size / 10 * FLAGS_gc_new_ratio);
+        _survivorSize = alignDown(newSize / (FLAGS_gc_survivor_ratio + 2));
+        _edenSize = newSize - (_survivorSize << 1);
+        _edenLimit = _edenSize;
+        _survivalRate = FLAGS_gc_target_survival_rate;
+        _epoch = _nextEpoch.fetch_add(1);
 
         _eden = _heap;
         _from = _eden + _edenSize;
@@ -34,73 +42,145 @@ namespace Ciallang::GC {
         _majorGC = new MarkSweep{
                 reinterpret_cast<Cell*>(_heap + newSize), tail, _rootsSet
         };
+        _majorGC->rememberedSet(&_rememberedSet);
+
+        // 待终结队列作为根集合, 随 _rootsSet 一起释放
+        _references = std::make_unique<ReferenceProcessor>(allocateRoots());
+        _majorGC->references(_references.get());
+
+        if(FLAGS_gc_max_heap_size > 0) {
+            _majorGC->maxCells((FLAGS_gc_max_heap_size - std::min<size_t>(FLAGS_gc_max_heap_size, newSize)) / NODE_SIZE);
+        }
+
+        tracing(!FLAGS_gc_trace_file.empty());
     }
 
     Generational::~Generational() {
+        if(_tracer && !FLAGS_gc_trace_file.empty()) {
+            _tracer->writeFile(FLAGS_gc_trace_file);
+        }
+
         delete _majorGC;
 
         for(auto& roots : _rootsSet) {
             delete roots;
         }
 
-        for(auto& obj : _permHeap) {
-            delete obj;
-        }
-
         free(_heap);
     }
 
     void Generational::minorGC() {
         LOG_EVERY_T(INFO, 5) << "MinorGC(CopyingGC) Running";
 
+        const auto begin = GCTracer::Clock::now();
+
+        // 上一次存活下来的对象现在在 from 区
+        const size_t fromUsed = _nextForwardingOffset;
+        const size_t collectedBytes = _nextFreeOffset + fromUsed;
+
         _nextForwardingOffset = 0;
+        _promotedBytes = 0;
 
         for(auto& roots : _rootsSet) {
             for(auto& root : *roots) {
-                if(reinterpret_cast<uintptr_t>(root)
-                   <= reinterpret_cast<uintptr_t>(_eden + _edenSize + _survivorSize)) {
-                    copy(root);
-                }
+                copy(root);
             }
         }
 
-        auto it = _rememberedSet.begin();
-        while(it != _rememberedSet.end()) {
-            bool hasNewObj = false;
+        // 晋升的对象可能被追加到记忆集末尾, 不能使用迭代器
+        size_t index = 0;
+        while(index < _rememberedSet.size()) {
+            GCObject* obj = _rememberedSet[index];
 
-            auto fields = (*it)->getFields();
-            if(fields.has_value()) {
-                for(auto& field : fields.value()) {
-                    if(reinterpret_cast<uintptr_t>(field) < _majorGC->start()) {
-                        copy(field);
-                        hasNewObj = reinterpret_cast<uintptr_t>(field) < _majorGC->start();
-                    }
-                }
+            obj->trace([&](GCObject*& field) {
+                copy(field);
+            });
+
+            // 字段都晋升到老年代后不再需要记录
+            if(hasYoungField(obj)) {
+                ++index;
+                continue;
             }
 
-            if(hasNewObj) {
-                (*it)->remembered(false);
+            obj->remembered(false);
+            swap(_rememberedSet[index], _rememberedSet.back());
+            _rememberedSet.pop_back();
+        }
 
-                if(it != _rememberedSet.end() - 1) {
-                    swap(*it, _rememberedSet.back());
-                }
+        // 没有被复制的新生代对象已经死亡
+        const auto forward = [&](GCObject* obj) -> GCObject* {
+            if(!isYoung(obj) || isSurvivor(obj)) return obj;
+            return obj->forwarded() ? obj->forwarding() : nullptr;
+        };
+        _references->processWeakRefs(forward);
+        _references->processFinalizers(forward, [&](GCObject*& obj) {
+            copy(obj);
+        });
 
-                _rememberedSet.pop_back();
-            } else {
-                ++it;
-            }
-        }
+        // 只有用过的部分需要清空
+        memset(_eden, 0, _nextFreeOffset);
+        memset(_from, 0, fromUsed);
 
         _nextFreeOffset = 0;
 
-        memset(_eden, 0, _edenSize);
-        memset(_from, 0, _survivorSize);
-
         swap(_from, _to);
+
+        // 所有线程的 TLAB 都指向已经清空的 eden
+        _epoch = _nextEpoch.fetch_add(1);
+
+        const size_t survivedBytes = _nextForwardingOffset + _promotedBytes;
+        resizeNursery(collectedBytes, survivedBytes);
+
+        _counters.lastCollectedBytes = collectedBytes;
+        _counters.lastSurvivedBytes = _nextForwardingOffset;
+        _counters.lastPromotedBytes = _promotedBytes;
+        _counters.lastSurvivalRate = collectedBytes == 0
+                                         ? 0.0
+                                         : static_cast<double>(survivedBytes) / static_cast<double>(collectedBytes);
+        _counters.collectedBytes += collectedBytes;
+        _counters.survivedBytes += _nextForwardingOffset;
+        _counters.promotedBytes += _promotedBytes;
+        _counters.youngFreedBytes += collectedBytes - std::min(collectedBytes, survivedBytes);
+
+        const auto end = GCTracer::Clock::now();
+        _minorPause.record(end - begin);
+        if(_tracer) {
+            _tracer->complete("minor", begin, end, {
+                                  { "collectedBytes", collectedBytes },
+                                  { "survivedBytes", _nextForwardingOffset },
+                                  { "promotedBytes", _promotedBytes },
+                                  { "rememberedSet", _rememberedSet.size() }
+                              });
+        }
+
+        if(FLAGS_gc_pretenuring) {
+            AllocationSite::decideAll();
+        }
+
+        // 标记中访问过的新生代地址已经被复用
+        if(_majorGC->marking()) {
+            _majorGC->youngEvacuated();
+        }
+
+        if(!_majorGC->marking() && !_majorGC->sweeping()
+           && _majorGC->occupancy() >= MARK_START_OCCUPANCY) {
+            _majorGC->startMarking();
+        }
+
+        // 顺带推进老年代的标记或清除, 分摊 major GC 的停顿
+        majorStep();
     }
 
     void Generational::copy(GCObject*& obj) {
-        if(!obj || obj->forwarded()) return;
+        if(!obj || !isYoung(obj) || isSurvivor(obj)) return;
+
+        // 已经被复制或晋升, 只需要更新引用
+        if(obj->forwarded()) {
+            obj = obj->forwarding();
+            return;
+        }
+
+        if(obj->age() == 0) recordSurvivor(obj);
 
         if(obj->age() >= MAX_AGE
            // `to area` is full
@@ -110,50 +190,139 @@ namespace Ciallang::GC {
         }
 
         auto* forwarding = obj->copyTo(_to + _nextForwardingOffset);
-        forwarding->forwarded(false);
+        forwarding->forwardTo(nullptr);
         forwarding->remembered(false);
+        forwarding->marked(false);
         forwarding->ageIncrement();
-        obj->forwarded(true);
-
-        for(auto& ptr : _rememberedSet) {
-            if(ptr == obj) {
-                ptr = forwarding;
-                break;
-            }
-        }
+        obj->forwardTo(forwarding);
 
         obj = forwarding;
 
         _nextForwardingOffset += obj->size();
 
-        handleFields(obj, [&](GCObject*& field) {
+        obj->trace([&](GCObject*& field) {
             copy(field);
         });
     }
 
+    GCStats Generational::stats() const {
+        GCStats stats = _counters;
+
+        stats.minorPause = _minorPause;
+        stats.markPause = _majorGC->markPause();
+        stats.sweepPause = _majorGC->sweepPause();
+        stats.compactPause = _majorGC->compactPause();
+        stats.markCycles = _majorGC->markCycles();
+
+        stats.oldFreedBytes = _majorGC->freedBytes();
+        stats.oldLiveBytes = _majorGC->liveBytes();
+        stats.oldCapacity = _majorGC->cellCount() * NODE_SIZE;
+        stats.permBytes = _permSpace->usedBytes();
+
+        stats.weakRefs = _references->weakRefCount();
+        stats.clearedWeakRefs = _references->clearedWeakRefs();
+        stats.pendingFinalizers = _references->pendingCount();
+        stats.finalizedObjects = _references->finalizedObjects();
+
+        stats.survivalRate = _survivalRate;
+        stats.rememberedSetSize = _rememberedSet.size();
+        stats.edenLimit = _edenLimit;
+
+        return stats;
+    }
+
+    void Generational::tracing(const bool enable) {
+        if(enable && !_tracer) {
+            _tracer = std::make_unique<GCTracer>();
+        } else if(!enable) {
+            _tracer.reset();
+        }
+
+        _majorGC->tracer(_tracer.get());
+    }
+
+    void Generational::refillTlab(const size_t size) {
+        std::lock_guard lock{ _allocLock };
+
+        // 旧 TLAB 剩下的空间直接丢弃, 下一次 minor GC 时回收
+        if(_nextFreeOffset + size > _edenLimit) {
+            minorGC();
+            if(_nextFreeOffset + size > _edenLimit) {
+                LOG(FATAL) << "[New] Allocation Failed! OutOfMemory...";
+            }
+        }
+
+        const size_t tlabSize = std::min(std::max(size, TLAB_SIZE), _edenLimit - _nextFreeOffset);
+
+        _tlab.top = _eden + _nextFreeOffset;
+        _tlab.end = _tlab.top + tlabSize;
+        _tlab.epoch = _epoch.load(std::memory_order_relaxed);
+
+        _nextFreeOffset += tlabSize;
+
+        // 按 TLAB 计算分配量, 标记增量的频率不受对象大小影响
+        _allocatedSinceStep += tlabSize;
+        if(_majorGC->marking() && _allocatedSinceStep >= MARK_STEP_BYTES) {
+            majorStep();
+        }
+    }
+
+    void Generational::resizeNursery(const size_t collectedBytes, const size_t survivedBytes) {
+        if(!FLAGS_gc_adaptive_nursery || collectedBytes == 0) return;
+
+        const double rate = static_cast<double>(survivedBytes) / static_cast<double>(collectedBytes);
+        _survivalRate = _survivalRate * (1 - SURVIVAL_WEIGHT) + rate * SURVIVAL_WEIGHT;
+
+        if(_survivalRate > FLAGS_gc_target_survival_rate) {
+            // 对象还没来得及死亡就被复制, 扩大 eden 拉长两次 minor GC 的间隔
+            _edenLimit = std::min(_edenLimit << 1, _edenSize);
+        } else if(_survivalRate < FLAGS_gc_target_survival_rate / 4) {
+            // 几乎没有对象存活, 缩小 eden 以减少占用的缓存和内存
+            _edenLimit = std::max(_edenLimit >> 1, std::min(_edenSize, MIN_EDEN_SIZE));
+        }
+    }
+
+    void Generational::recordSurvivor(const GCObject* obj) const {
+        // 只有 eden 中的对象后面可能有 memento
+        const auto* memory = reinterpret_cast<const uint8_t*>(obj) + obj->size();
+        if(memory < _eden || memory + sizeof(AllocationMemento) > _eden + _nextFreeOffset) return;
+
+        const auto* memento = reinterpret_cast<const AllocationMemento*>(memory);
+        if(memento->magic == AllocationMemento::MAGIC) {
+            memento->site->recordSurvivor();
+        }
+    }
+
     void Generational::promotion(GCObject*& obj) {
+        GCObject* young = obj;
         _majorGC->reallocate(obj);
+        _promotedBytes += obj->size();
 
-        obj->forwarded(true);
+        obj->remembered(false);
+        young->forwardTo(obj);
 
-        handleFields(obj, [&](GCObject*& field) {
-            if(reinterpret_cast<uintptr_t>(field) < _majorGC->start()) {
-                obj->remembered(true);
-                _rememberedSet.push_back(obj);
-            }
+        obj->trace([&](GCObject*& field) {
+            copy(field);
         });
+
+        // 字段还留在新生代, 形成跨代引用
+        if(hasYoungField(obj)) {
+            obj->remembered(true);
+            _rememberedSet.push_back(obj);
+        }
     }
 
     void Generational::printState() const {
         static constexpr auto TABLE_SIZE = 60;
         static constexpr auto COL_COUNT = 5;
 
-        size_t edenFree = _edenSize - _nextFreeOffset;
+        size_t edenFree = _edenLimit - _nextFreeOffset;
         size_t survivorFree = _survivorSize - _nextForwardingOffset;
 
-        size_t oldSpaceCapacity = _heapSize - _edenSize - (_survivorSize << 1);
-        size_t oldSpaceUsed = _majorGC->end() - _majorGC->free();
-        size_t oldSpaceFree = oldSpaceCapacity - oldSpaceUsed;
+        // 老年代按 cell 分配, 空闲 cell 可能分散在整个老年代, 不能用地址差计算
+        size_t oldSpaceCapacity = _majorGC->cellCount() * NODE_SIZE;
+        size_t oldSpaceUsed = _majorGC->liveBytes();
+        size_t oldSpaceFree = (_majorGC->cellCount() - _majorGC->usedCells()) * NODE_SIZE;
 
 
         const std::any table[][COL_COUNT] = {
@@ -163,11 +332,11 @@ namespace Ciallang::GC {
                 {},
                 { "Space", "Eden", "From", "To", "Old" },
                 {},
-                { "Capacity", _edenSize, _survivorSize, _survivorSize, oldSpaceCapacity },
+                { "Capacity", _edenLimit, _survivorSize, _survivorSize, oldSpaceCapacity },
                 { "Used", _nextFreeOffset, _nextForwardingOffset, 0, oldSpaceUsed },
                 { "Free", edenFree, survivorFree, 0, oldSpaceFree },
                 { "Used(%)",
-                  static_cast<double>(_nextFreeOffset) / _edenSize * 100,
+                  static_cast<double>(_nextFreeOffset) / _edenLimit * 100,
                   static_cast<double>(_nextForwardingOffset) / _survivorSize * 100,
                   0.00,
                   static_cast<double>(oldSpaceUsed) / oldSpaceCapacity * 100
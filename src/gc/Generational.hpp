@@ -13,26 +13,71 @@
  */
 #pragma once
 
+#include "AllocationSite.hpp"
 #include "GC.hpp"
+#include "GCFlags.hpp"
+#include "GCStats.hpp"
+#include "GCTracer.hpp"
 #include "MarkSweep.hpp"
+#include "PermSpace.hpp"
 
 namespace Ciallang::GC {
-    // 新生代与老年代比例, New : Old = 2 : 8
-    static constexpr size_t NEW_RATIO = 2;
-
-    // 新生代中 Eden 和 from, to 比例
-    // Eden: From : To = 8 : 1 : 1
-    static constexpr size_t SURVIVOR_RATIO = 8;
+    // 新生代与老年代比例由 --gc_new_ratio 配置, 默认 New : Old = 2 : 8
+    // Eden 和 from, to 比例由 --gc_survivor_ratio 配置, 默认 Eden: From : To = 8 : 1 : 1
 
     static constexpr size_t MAX_AGE = 3;
 
+    // 各个区的起始地址按这个值对齐
+    static constexpr size_t SPACE_ALIGNMENT = alignof(std::max_align_t);
+
+    // 自动调整时 eden 不会小于这个值 (或者整个 eden)
+    static constexpr size_t MIN_EDEN_SIZE = 256 * 1024;
+
+    // 存活率的指数移动平均中, 最新一次 minor GC 的权重
+    static constexpr double SURVIVAL_WEIGHT = 0.3;
+
+    // 每次从 eden 中为线程划分的分配缓冲区大小
+    static constexpr size_t TLAB_SIZE = 4 * 1024;
+
+    // 老年代占用超过这个比例时开始增量标记
+    static constexpr double MARK_START_OCCUPANCY = 0.75;
+
+    // 增量标记期间, 新生代每分配这么多字节执行一次标记增量
+    static constexpr size_t MARK_STEP_BYTES = 16 * 1024;
+
+    /**
+     * 线程本地分配缓冲区, epoch 与堆的 _epoch 不同时失效.
+     * 每个线程只缓存一个堆的 TLAB, 在多个堆之间交替分配会频繁重新划分
+     */
+    struct Tlab {
+        uint8_t* top{ nullptr };
+        uint8_t* end{ nullptr };
+        uint64_t epoch{};
+    };
+
     /**
      * New Gen GC: Copying
-     * Old Gen GC: Marked-Sweep
+     * Old Gen GC: Marked-Sweep (incremental), Mark-Compact (optional)
+     *
+     * 老年代的标记和清除都以增量方式穿插在分配中执行,
+     * 宿主也可以在自己的安全点调用 safepoint 推进
+     *
+     * 老年代按需申请新的块, 新生代的空间在构造时预留,
+     * 实际使用的 eden 大小 (_edenLimit) 根据 minor GC 的存活率调整
+     *
+     * 每个线程从 eden 中划出一块 TLAB, 在 TLAB 内分配不需要加锁;
+     * 只有划分新的 TLAB 和通过预晋升的分配点在老年代分配时才持有 _allocLock.
+     * 直接调用 allocateOldSpace 不加锁, 只能在单线程中使用. minor GC 会让所有 TLAB 失效,
+     * 调用方需要保证此时其他线程没有在访问这个堆
+     *
+     * 通过 AllocationSite 分配时, 存活率高的分配点会被改为直接在老年代分配 (预晋升),
+     * 省去在 eden 和 survivor 之间反复复制
+     *
+     * 宿主可以把不会死亡的对象分配在永久区, 永久区可以在 freeze 后由多个堆共享
      */
     class Generational {
     public:
-        explicit Generational(size_t size);
+        explicit Generational(size_t size, std::shared_ptr<PermSpace> permSpace = nullptr);
 
         ~Generational();
 
@@ -43,6 +88,32 @@ namespace Ciallang::GC {
 
         void minorGC();
 
+        // 整理老年代
+        void compact() {
+            minorGC();
+            _majorGC->compact();
+        }
+
+        // 推进一次老年代的标记或清除增量, 并执行待终结对象的终结器.
+        // 老年代对象只会在这里 (以及 collect, compact) 被整理移动, 分配时不会
+        void safepoint() {
+            if(!_majorGC->marking() && _majorGC->compactPending()) {
+                _majorGC->compact();
+            } else {
+                majorStep();
+            }
+            runFinalizers();
+        }
+
+        WeakRef* createWeakRef(GCObject* target) { return _references->createWeakRef(target); }
+
+        void releaseWeakRef(const WeakRef* ref) { _references->releaseWeakRef(ref); }
+
+        void registerFinalizer(GCObject* obj) { _references->registerFinalizer(obj); }
+
+        // 终结器可能在分配中触发的 minor GC 之外执行, 只在安全点调用
+        size_t runFinalizers() { return _references->runFinalizers(); }
+
         // copy object from new area to from area
         void copy(GCObject*& obj);
 
@@ -50,41 +121,59 @@ namespace Ciallang::GC {
 
         template <typename T, typename... Args>
             requires is_gc_object_v<T>
-        T* allocateNewSpace(Args... args) {
-            //检查是否可以分配
-            if(_nextFreeOffset + sizeof(T) > _edenSize) {
-                minorGC();
-                if(_nextFreeOffset + sizeof(T) > _edenSize) {
-                    LOG(FATAL) << "[New] Allocation Failed! OutOfMemory...";
-                }
-            }
-
+        T* allocateNewSpace(Args&&... args) {
             //分配
-            T* newObj = new(_eden + _nextFreeOffset) T(std::forward<Args>(args)...);
+            T* newObj = new(allocateRaw(sizeof(T))) T(std::forward<Args>(args)...);
 
             //初始化
-            newObj->forwarded(false);
+            newObj->forwardTo(nullptr);
+            newObj->marked(false);
+            newObj->age(0);
+
+            return newObj;
+        }
+
+        // 通过分配点分配, 根据分配点的存活率选择新生代或者老年代
+        template <typename T, typename... Args>
+            requires is_gc_object_v<T>
+        T* allocate(AllocationSite& site, Args&&... args) {
+            site.recordAllocation();
+
+            // 老年代的空闲链表不是线程安全的, 预晋升与划分 TLAB 共用 _allocLock
+            if(site.tenured() && FLAGS_gc_pretenuring) {
+                std::lock_guard lock{ _allocLock };
+                _counters.pretenuredBytes += sizeof(T);
+                return allocateOldSpace<T>(std::forward<Args>(args)...);
+            }
+
+            uint8_t* memory = allocateRaw(sizeof(T) + sizeof(AllocationMemento));
+
+            T* newObj = new(memory) T(std::forward<Args>(args)...);
+            newObj->forwardTo(nullptr);
             newObj->marked(false);
             newObj->age(0);
 
-            //分配后, free移动至下一个可分配位置
-            _nextFreeOffset += sizeof(T);
+            new(memory + sizeof(T)) AllocationMemento{ AllocationMemento::MAGIC, &site };
 
             return newObj;
         }
 
         template <typename T, typename... Args>
             requires is_gc_object_v<T>
-        T* allocateOldSpace(Args... args) {
+        T* allocateOldSpace(Args&&... args) {
+            if(FLAGS_gc_torture) [[unlikely]] collect();
+
             return _majorGC->allocate<T>(std::forward<Args>(args)...);
         }
 
         template <typename T, typename... Args>
             requires is_gc_object_v<T>
-        T* allocatePermSpace(Args... args) {
-            return _permHeap.push_back(new T{ std::forward<T>(args)... });
+        T* allocatePermSpace(Args&&... args) {
+            return _permSpace->allocate<T>(std::forward<Args>(args)...);
         }
 
+        [[nodiscard]] const std::shared_ptr<PermSpace>& permSpace() const noexcept { return _permSpace; }
+
         template <typename T>
             requires is_gc_object_v<T>
         void updatePtr(GCObject* obj, T** fieldRef, T* newObj) {
@@ -94,17 +183,50 @@ namespace Ciallang::GC {
         template <typename T>
             requires is_gc_object_v<T>
         void writeBarrier(GCObject* obj, T** fieldRef, T* newObj) {
-            if(reinterpret_cast<uintptr_t>(obj) >= _majorGC->start()
-               && reinterpret_cast<uintptr_t>(newObj)
-               <= reinterpret_cast<uintptr_t>(_eden + _edenSize + _survivorSize)
-               && !obj->remembered()) {
+            // 永久区不会被扫描, 只能引用永久区的对象
+            DCHECK(!obj->perm() || !newObj || newObj->perm()) << "Perm object can only refer to perm objects";
+
+            // Dijkstra 插入屏障, 黑色对象不能直接引用白色对象
+            if(_majorGC->marking()) {
+                _majorGC->shade(newObj);
+            }
+
+            if(_majorGC->contains(obj) && isYoung(newObj) && !obj->remembered()) {
+                obj->remembered(true);
                 _rememberedSet.push_back(obj);
             }
             *fieldRef = newObj;
         }
 
+        bool isYoung(const GCObject* obj) const noexcept {
+            const auto* address = reinterpret_cast<const uint8_t*>(obj);
+            return address >= _heap && address < _heap + _edenSize + (_survivorSize << 1);
+        }
+
+        // 本轮 minor GC 已经复制到 to 区的对象
+        bool isSurvivor(const GCObject* obj) const noexcept {
+            const auto* address = reinterpret_cast<const uint8_t*>(obj);
+            return address >= _to && address < _to + _survivorSize;
+        }
+
         void printState() const;
 
+        // 老年代是否正在增量标记
+        [[nodiscard]] bool marking() const noexcept { return _majorGC->marking(); }
+
+        // 当前实际使用的 eden 大小
+        [[nodiscard]] size_t edenLimit() const noexcept { return _edenLimit; }
+
+        // minor GC 存活率的移动平均
+        [[nodiscard]] double survivalRate() const noexcept { return _survivalRate; }
+
+        [[nodiscard]] GCStats stats() const;
+
+        // 开启后每次停顿都会记录为一个 trace 事件, --gc_trace_file 不为空时析构时写入该文件
+        void tracing(bool enable);
+
+        [[nodiscard]] GCTracer* tracer() const noexcept { return _tracer.get(); }
+
 
         Roots& allocateRoots() {
             auto* roots = new Roots{};
@@ -113,11 +235,22 @@ namespace Ciallang::GC {
         }
 
     private:
+        inline static thread_local Tlab _tlab{};
+
+        // 每个堆创建时和每次 minor GC 后取一个新的值, 不同的堆之间也不会重复
+        inline static std::atomic<uint64_t> _nextEpoch{ 1 };
+
+        std::atomic<uint64_t> _epoch{};
+
+        std::mutex _allocLock{};
+
         std::vector<Roots*> _rootsSet{};
 
         std::vector<GCObject*> _rememberedSet{};
 
-        std::vector<GCObject*> _permHeap{ 2000 };
+        std::unique_ptr<ReferenceProcessor> _references{};
+
+        std::shared_ptr<PermSpace> _permSpace;
 
         uint8_t* _heap;
         uint8_t* _eden;
@@ -127,9 +260,21 @@ namespace Ciallang::GC {
         size_t _nextForwardingOffset{};
         size_t _nextFreeOffset{};
 
+        size_t _allocatedSinceStep{};
+
 
         size_t _heapSize{};
         size_t _edenSize{};
+        size_t _edenLimit{};
+
+        // 本次 minor GC 晋升的字节数
+        size_t _promotedBytes{};
+        double _survivalRate{};
+
+        PauseStats _minorPause{};
+        GCStats _counters{};
+
+        std::unique_ptr<GCTracer> _tracer{};
 
         // from 和 to 交替使用,
         // survivorSize 是单个区的 from 或 to 的大小,
@@ -145,13 +290,52 @@ namespace Ciallang::GC {
             to = temp;
         }
 
-        static void handleFields(const GCObject* obj, const std::function<void(GCObject*&)>& func) {
-            auto fields = obj->getFields();
-            if(fields.has_value()) {
-                for(auto& field : fields.value()) {
-                    func(field);
-                }
+        void majorStep() {
+            _allocatedSinceStep = 0;
+            if(_majorGC->marking()) {
+                _majorGC->markStep();
+            } else {
+                _majorGC->sweepStep();
+            }
+        }
+
+        // 为当前线程划分新的 TLAB, eden 不足时执行 minor GC
+        void refillTlab(size_t size);
+
+        uint8_t* allocateRaw(const size_t size) {
+            if(FLAGS_gc_torture) [[unlikely]] {
+                std::lock_guard lock{ _allocLock };
+                minorGC();
+            }
+
+            //检查当前线程的 TLAB 是否可以分配
+            if(_tlab.epoch != _epoch.load(std::memory_order_acquire)
+               || _tlab.top + size > _tlab.end) {
+                refillTlab(size);
             }
+
+            //分配后, top移动至下一个可分配位置
+            uint8_t* memory = _tlab.top;
+            _tlab.top += size;
+            return memory;
+        }
+
+        // 对象第一次存活时, 把存活记录到它的分配点
+        void recordSurvivor(const GCObject* obj) const;
+
+        // 根据本次 minor GC 的存活率调整 eden 大小
+        void resizeNursery(size_t collectedBytes, size_t survivedBytes);
+
+        static constexpr size_t alignDown(const size_t size) {
+            return size / SPACE_ALIGNMENT * SPACE_ALIGNMENT;
+        }
+
+        bool hasYoungField(GCObject* obj) const {
+            bool found = false;
+            obj->trace([&](GCObject*& field) {
+                found = found || (field && isYoung(field));
+            });
+            return found;
         }
     };
 }
@@ -13,77 +13,680 @@
  */
 #include "MarkSweep.hpp"
 
+#include "GCFlags.hpp"
+#include "collections/WorkStealingDeque.hpp"
+
 namespace Ciallang::GC {
     MarkSweep::MarkSweep(Cell* heap,
                          Cell* tail,
                          std::vector<Roots*>& rootsSet) :
         _rootsSet(rootsSet),
-        _head(heap),
-        _tail(tail) {
-        _nextFree = _head;
+        _markThreads(std::max<size_t>(FLAGS_gc_mark_threads, 1)),
+        _compactThreshold(FLAGS_gc_compact_threshold),
+        _growOccupancy(FLAGS_gc_heap_grow_occupancy) {
+        // initFreeList 已经按地址顺序把所有 cell 串起来了
+        _freeList = heap;
+        _cellCount = (reinterpret_cast<uintptr_t>(tail) - reinterpret_cast<uintptr_t>(heap)) / NODE_SIZE + 1;
+        _regions.push_back({ heap, 0, _cellCount, false });
+
+        // 还没有需要清除的页
+        resetPages();
+
+        concurrentSweep(FLAGS_gc_concurrent_sweep);
+    }
+
+    MarkSweep::~MarkSweep() {
+        concurrentSweep(false);
+
+        for(const auto& region : _regions) {
+            if(region.owned) std::free(region.head);
+        }
+    }
+
+    size_t MarkSweep::grow(size_t cells) {
+        if(_maxCells > 0) {
+            cells = std::min(cells, _maxCells - std::min(_maxCells, _cellCount));
+        }
+        if(cells == 0) return 0;
+
+        // 清除中的页数不能变化
+        if(sweeping()) sweep();
+
+        auto* memory = static_cast<uint8_t*>(malloc(cells * NODE_SIZE));
+        if(!memory) {
+            LOG(FATAL) << "Grow Old Generation Failed! OutOfMemory...";
+        }
+
+        Cell* tail = initFreeList(cells * NODE_SIZE, memory);
+        Cell* head = reinterpret_cast<Cell*>(memory);
+        _regions.push_back({ head, _cellCount, cells, true });
+        _cellCount += cells;
+        resetPages();
+
+        tail->next = _freeList;
+        _freeList = head;
+
+        LOG(INFO) << "Old generation grown to " << _cellCount << " cells";
+        return cells;
+    }
+
+    void MarkSweep::growIfNeeded() {
+        if(_growOccupancy <= 0) return;
+
+        const double occupancy = static_cast<double>(_markedCells) / static_cast<double>(_cellCount);
+        if(occupancy >= _growOccupancy) grow(_cellCount);
+    }
+
+    void MarkSweep::shrink(const size_t liveCells) {
+        if(_growOccupancy <= 0) return;
+
+        while(_regions.size() > 1) {
+            const Region& last = _regions.back();
+            if(!last.owned || last.firstIndex < liveCells) break;
+
+            // 释放后存活比例仍然远低于扩容阈值才释放, 避免反复扩容和收缩
+            const size_t remaining = _cellCount - last.cellCount;
+            if(static_cast<double>(liveCells) / static_cast<double>(remaining) >= _growOccupancy / 2) break;
+
+            std::free(last.head);
+            _cellCount = remaining;
+            _regions.pop_back();
+
+            LOG(INFO) << "Old generation shrunk to " << _cellCount << " cells";
+        }
+
+        resetPages();
+    }
+
+    void MarkSweep::recordPause(PauseStats& stats,
+                                const char* name,
+                                const Clock::time_point begin,
+                                GCTracer::Args&& args) {
+        const auto end = Clock::now();
+        stats.record(end - begin);
+
+        if(_tracer) _tracer->complete(name, begin, end, std::move(args));
+    }
+
+    void MarkSweep::resetPages() {
+        const size_t pageCount = (_cellCount + PAGE_CELLS - 1) / PAGE_CELLS;
+
+        // 先把认领位置推到末尾, 后台线程不会认领到新增的页
+        _nextSweepPage.store(pageCount, std::memory_order_release);
+        _sweptPages.store(pageCount, std::memory_order_release);
+        _pageCount.store(pageCount, std::memory_order_release);
+    }
+
+    void MarkSweep::concurrentSweep(const bool enable) {
+        if(enable == concurrentSweep()) return;
+
+        if(enable) {
+            _sweeperStop = false;
+            _sweeper = std::thread{ &MarkSweep::backgroundSweep, this };
+            return;
+        }
+
+        {
+            std::lock_guard lock{ _sweeperLock };
+            _sweeperStop = true;
+        }
+        _sweeperCond.notify_one();
+        _sweeper.join();
     }
 
     void MarkSweep::collect() {
         LOG_EVERY_T(INFO, 5) << "MarkSweepGC Running";
+
+        if(!marking()) startMarking();
+        completeMarking();
+
+        if(compactPending()) {
+            evacuate();
+        } else {
+            startSweep();
+        }
+    }
+
+    void MarkSweep::startMarking() {
+        if(marking()) return;
+
+        // 未清除的页中还残留上一轮的标记位, 必须先清除完
+        if(sweeping()) sweep();
+
+        const auto begin = Clock::now();
+        _marking = true;
+        _markedBytes = 0;
+        _markedCells = 0;
+        _youngVisited.clear();
+        scanRoots();
+        recordPause(_markPause, "mark", begin);
+    }
+
+    bool MarkSweep::markStep() {
+        if(!marking()) return true;
+
+        const auto begin = Clock::now();
+        const bool drained = drain(begin + _markBudget);
+        recordPause(_markPause, "mark", begin);
+
+        if(drained) finishMarking();
+
+        return !marking();
+    }
+
+    void MarkSweep::finishMarking() {
+        if(!marking()) return;
+
+        completeMarking();
+
+        // markStep 在分配中途调用, 调用方可能还持有老年代对象的指针, 这里只清除,
+        // 整理留给 collect, compact 或者宿主的安全点
+        startSweep();
+    }
+
+    void MarkSweep::compact() {
+        LOG_EVERY_T(INFO, 5) << "MarkCompactGC Running";
+
+        if(!marking()) startMarking();
+        completeMarking();
+        evacuate();
+    }
+
+    void MarkSweep::completeMarking() {
+        const auto begin = Clock::now();
+
+        // 根集合没有写屏障, 需要重新扫描
+        scanRoots();
+        drain({});
+
+        if(_references) processReferences();
+
+        _marking = false;
+        _youngVisited.clear();
+        _liveBytes = _markedBytes;
+        ++_markCycles;
+
+        // 死亡的对象清除后就失效了, 不能留在记忆集中
+        if(_rememberedSet) {
+            std::erase_if(*_rememberedSet, [&](const GCObject* obj) {
+                return contains(obj) && !obj->marked();
+            });
+        }
+
+        size_t highest = _cellCount;
+        while(highest > 0 && !liveAt(highest - 1)) --highest;
+        _fragmentation = highest == 0
+                             ? 0.0
+                             : 1.0 - static_cast<double>(_markedCells) / static_cast<double>(highest);
+
+        growIfNeeded();
+
+        recordPause(_markPause, "mark", begin, {
+                        { "liveBytes", _liveBytes },
+                        { "liveCells", _markedCells }
+                    });
+    }
+
+    void MarkSweep::startSweep() {
+        // 空闲链表在清除时重新建立
+        _freeList = nullptr;
+        {
+            std::lock_guard lock{ _sweptLock };
+            _sweptList = nullptr;
+        }
+        _sweptPages.store(0, std::memory_order_release);
+        _nextSweepPage.store(0, std::memory_order_release);
+
+        if(concurrentSweep()) {
+            {
+                std::lock_guard lock{ _sweeperLock };
+                ++_sweepEpoch;
+            }
+            _sweeperCond.notify_one();
+        }
+    }
+
+    void MarkSweep::evacuate() {
+        const auto begin = Clock::now();
+
+        size_t freedBytes{};
+
+        // 双指针: low 找空闲 cell, high 找存活对象, 相遇时所有存活对象都在 low 之下
+        size_t low = 0;
+        size_t high = _cellCount;
+        for(;;) {
+            while(low < high && liveAt(low)) ++low;
+            while(high > low && !liveAt(high - 1)) --high;
+            if(low >= high) break;
+
+            Cell* to = cellAt(low);
+            Cell* from = cellAt(high - 1);
+
+            if(GCObject* dead = to->data) {
+                freedBytes += dead->size();
+                memset((void*)dead, 0, dead->size());
+            }
+
+            GCObject* moved = from->data->copyTo(reinterpret_cast<uint8_t*>(to + 1));
+            moved->forwardTo(nullptr);
+            to->data = moved;
+
+            // 旧对象保留到所有引用更新完
+            from->data->forwardTo(moved);
+
+            ++low;
+            --high;
+        }
+
+        const size_t liveCells = low;
+
+        std::vector<GCObject*> young{};
+        const FieldVisitor update = [&](GCObject*& ref) {
+            if(!ref || ref->perm()) return;
+
+            if(!contains(ref)) {
+                if(_youngVisited.insert(ref).second) young.push_back(ref);
+                return;
+            }
+
+            if(ref->forwarded()) ref = ref->forwarding();
+        };
+
         for(auto& roots : _rootsSet) {
             for(auto& obj : *roots) {
-                if(obj && reinterpret_cast<uintptr_t>(obj) >= start())
-                    mark(obj);
+                update(obj);
             }
         }
-        sweep();
-    }
 
-    Cell* MarkSweep::findIdleNode() {
-        auto find = [&] {
-            _nextFree = _head;
-            while(_nextFree && _nextFree->data) {
-                _nextFree = _nextFree->next;
+        for(size_t i = 0; i < liveCells; ++i) {
+            cellAt(i)->data->trace(update);
+        }
+
+        if(_references) {
+            _references->update([&](GCObject*& ref) {
+                if(contains(ref) && ref->forwarded()) ref = ref->forwarding();
+            });
+        }
+
+        while(!young.empty()) {
+            GCObject* obj = young.back();
+            young.pop_back();
+            obj->trace(update);
+        }
+        _youngVisited.clear();
+
+        if(_rememberedSet) {
+            for(auto& obj : *_rememberedSet) {
+                update(obj);
             }
+        }
+
+        for(size_t i = 0; i < liveCells; ++i) {
+            cellAt(i)->data->marked(false);
+        }
+
+        // 高地址的 cell 都空出来了, 按地址顺序重建空闲链表
+        for(size_t i = liveCells; i < _cellCount; ++i) {
+            Cell* cell = cellAt(i);
+
+            if(GCObject* obj = cell->data) {
+                if(!obj->forwarded()) freedBytes += obj->size();
+
+                // fill memory with zero
+                memset((void*)obj, 0, obj->size());
+                cell->data = nullptr;
+            }
+
+            cell->next = i + 1 < _cellCount ? cellAt(i + 1) : nullptr;
+        }
+
+        shrink(liveCells);
+
+        _freeList = nullptr;
+        if(liveCells < _cellCount) {
+            cellAt(_cellCount - 1)->next = nullptr;
+            _freeList = cellAt(liveCells);
+        }
+        {
+            std::lock_guard lock{ _sweptLock };
+            _sweptList = nullptr;
+        }
+
+        _usedCells.store(liveCells, std::memory_order_relaxed);
+        _freedBytes.fetch_add(freedBytes, std::memory_order_relaxed);
+        _fragmentation = 0.0;
+
+        recordPause(_compactPause, "compact", begin, {
+                        { "liveCells", liveCells },
+                        { "freedBytes", freedBytes }
+                    });
+    }
+
+    void MarkSweep::processReferences() {
+        // 新生代对象由 minor GC 处理
+        const auto forward = [&](GCObject* obj) -> GCObject* {
+            return !contains(obj) || obj->marked() ? obj : nullptr;
         };
 
-        find();
-        if(!_nextFree) collect();
-        find();
+        _references->processWeakRefs(forward);
+        _references->processFinalizers(forward, [&](GCObject*& obj) {
+            shade(obj);
+        });
 
-        if(!_nextFree) {
-            LOG(FATAL) << "Allcation Failed! OutOfMemory...";
+        // 复活的对象引用的对象也要存活
+        drain({});
+    }
+
+    void MarkSweep::shade(GCObject* obj) {
+        if(!obj || obj->perm()) return;
+
+        // 新生代对象不标记, 但要扫描它引用的老年代对象
+        // minor GC 随时可能移动并清空新生代对象, 所以它们不能留在 _markStack 中, 立即扫描完
+        if(!contains(obj)) {
+            if(visitYoung(obj)) {
+                _youngStack.push_back(obj);
+                if(!_scanningYoung) scanYoung();
+            }
+            return;
         }
 
-        return _nextFree;
+        if(obj->marked()) return;
+        obj->marked(true);
+        _markedBytes += obj->size();
+        ++_markedCells;
+        _markStack.push_back(obj);
     }
 
+    void MarkSweep::scanYoung() {
+        _scanningYoung = true;
+        while(!_youngStack.empty()) {
+            GCObject* obj = _youngStack.back();
+            _youngStack.pop_back();
+            scan(obj);
+        }
+        _scanningYoung = false;
+    }
+
+    bool MarkSweep::visitYoung(GCObject* obj) {
+        std::lock_guard lock{ _youngLock };
+        return _youngVisited.insert(obj).second;
+    }
+
+    void MarkSweep::scanRoots() {
+        for(auto& roots : _rootsSet) {
+            for(auto& obj : *roots) {
+                shade(obj);
+            }
+        }
+    }
+
+    void MarkSweep::scan(GCObject* obj) {
+        obj->trace([&](GCObject*& field) {
+            shade(field);
+        });
+    }
+
+    bool MarkSweep::drain(const std::optional<Clock::time_point> deadline) {
+        if(!deadline.has_value() && _markThreads > 1) {
+            drainParallel();
+            return true;
+        }
+
+        size_t scanned = 0;
+        while(!_markStack.empty()) {
+            if(deadline.has_value()
+               && ++scanned % MARK_CHECK_INTERVAL == 0
+               && Clock::now() >= deadline.value()) {
+                return false;
+            }
+
+            GCObject* obj = _markStack.back();
+            _markStack.pop_back();
+            scan(obj);
+        }
+        return true;
+    }
+
+    Cell* MarkSweep::findIdleNode() {
+        if(!_freeList) takeSweptCells();
+        if(!_freeList) lazySweep();
+
+        // 整理不会多出空闲 cell, 而且调用方 (例如晋升) 可能还持有老年代对象的指针, 这里只清除
+        if(!_freeList) {
+            if(!marking()) startMarking();
+            completeMarking();
+            startSweep();
+            lazySweep();
+        }
+
+        // 存活对象太多, 清除后仍然没有空闲 cell
+        if(!_freeList) grow(_cellCount);
+
+        if(!_freeList) {
+            LOG(FATAL) << "Allcation Failed! OutOfMemory...";
+        }
+
+        Cell* cell = _freeList;
+        _freeList = cell->next;
+        cell->next = nullptr;
+        _usedCells.fetch_add(1, std::memory_order_relaxed);
+
+        return cell;
+    }
 
     void MarkSweep::sweep() {
-        for(Cell* cursor = _head; cursor; cursor = cursor->next) {
-            if(!cursor->data) continue;
+        if(!sweeping()) return;
+
+        const auto begin = Clock::now();
+        while(sweepNextPage()) {}
+        waitSweepDone();
+        recordPause(_sweepPause, "sweep", begin);
+    }
+
+    bool MarkSweep::sweepStep() {
+        if(!sweeping()) return true;
+
+        const auto begin = Clock::now();
+        const auto deadline = begin + _sweepBudget;
+        while(sweepNextPage() && Clock::now() < deadline) {}
+        recordPause(_sweepPause, "sweep", begin);
 
-            GCObject* obj = cursor->data;
+        return !sweeping();
+    }
+
+    void MarkSweep::lazySweep() {
+        if(!sweeping()) return;
+
+        const auto begin = Clock::now();
+        while(!_freeList && sweeping()) {
+            // 所有页都被认领了, 只能等后台线程清除完
+            if(!sweepNextPage()) waitSweepDone();
+            takeSweptCells();
+        }
+        recordPause(_sweepPause, "sweep", begin);
+    }
+
+    bool MarkSweep::sweepNextPage() {
+        // 页数可能在两次清除之间变化, 不能直接 fetch_add
+        size_t page = _nextSweepPage.load(std::memory_order_acquire);
+        do {
+            if(page >= _pageCount.load(std::memory_order_acquire)) return false;
+        } while(!_nextSweepPage.compare_exchange_weak(
+            page, page + 1,
+            std::memory_order_acq_rel,
+            std::memory_order_acquire
+        ));
+
+        Cell* freeHead{ nullptr };
+        Cell* freeTail{ nullptr };
+        size_t freedBytes{};
+        size_t freedCells{};
 
-            if(obj->marked()) obj->marked(false);
-            else {
-                Cell* cell = reinterpret_cast<Cell*>(obj - 1);
+        const size_t first = page * PAGE_CELLS;
+        const size_t last = std::min(first + PAGE_CELLS, _cellCount);
+        for(size_t i = first; i < last; ++i) {
+            Cell* cell = cellAt(i);
 
-                LOG(INFO) << fmt::format("collection: {}B", obj->size());
+            if(GCObject* obj = cell->data) {
+                if(obj->marked()) {
+                    obj->marked(false);
+                    continue;
+                }
+
+                freedBytes += obj->size();
+                ++freedCells;
 
                 // fill memory with zero
                 memset((void*)obj, 0, obj->size());
                 cell->data = nullptr;
-
-                _nextFree = cell;
             }
+
+            cell->next = freeHead;
+            freeHead = cell;
+            if(!freeTail) freeTail = cell;
+        }
+
+        if(freeHead) {
+            std::lock_guard lock{ _sweptLock };
+            freeTail->next = _sweptList;
+            _sweptList = freeHead;
+        }
+
+        _freedBytes.fetch_add(freedBytes, std::memory_order_relaxed);
+        _usedCells.fetch_sub(freedCells, std::memory_order_relaxed);
+        _sweptPages.fetch_add(1, std::memory_order_acq_rel);
+
+        return true;
+    }
+
+    void MarkSweep::takeSweptCells() {
+        std::lock_guard lock{ _sweptLock };
+        if(!_sweptList) return;
+
+        Cell* tail = _sweptList;
+        while(tail->next) tail = tail->next;
+
+        tail->next = _freeList;
+        _freeList = _sweptList;
+        _sweptList = nullptr;
+    }
+
+    void MarkSweep::waitSweepDone() const {
+        while(sweeping()) {
+            std::this_thread::yield();
+        }
+    }
+
+    void MarkSweep::backgroundSweep() {
+        size_t epoch{};
+
+        std::unique_lock lock{ _sweeperLock };
+        for(;;) {
+            _sweeperCond.wait(lock, [&] { return _sweeperStop || _sweepEpoch != epoch; });
+            if(_sweeperStop) return;
+
+            epoch = _sweepEpoch;
+            lock.unlock();
+
+            while(!_sweeperStop && sweepNextPage()) {}
+
+            lock.lock();
         }
     }
 
     void MarkSweep::mark(GCObject* obj) {
-        if(!obj || obj->marked()) return;
-        obj->marked(true);
+        shade(obj);
+        drain({});
+    }
+
+    void MarkSweep::drainParallel() {
+        using Deque = Collections::WorkStealingDeque<GCObject*>;
+
+        const size_t threadCount = _markThreads;
+
+        std::vector<std::unique_ptr<Deque>> deques{};
+        for(size_t i = 0; i < threadCount; ++i) {
+            deques.push_back(std::make_unique<Deque>());
+        }
+
+        // 把灰色对象平均分给每个线程
+        for(size_t i = 0; i < _markStack.size(); ++i) {
+            deques[i % threadCount]->push(_markStack[i]);
+        }
+        _markStack.clear();
+
+        std::atomic<size_t> active{ threadCount };
+        std::atomic<size_t> totalBytes{};
+        std::atomic<size_t> totalCells{};
+
+        auto worker = [&](const size_t id) {
+            Deque& own = *deques[id];
+
+            size_t markedBytes{};
+            size_t markedCells{};
+
+            auto scanFields = [&](GCObject* obj) {
+                obj->trace([&](GCObject*& field) {
+                    if(!field || field->perm()) return;
 
-        auto fields = obj->getFields();
-        if(!fields.has_value()) return;
-        for(auto& field : fields.value()) {
-            if(reinterpret_cast<uintptr_t>(field) >= start())
-                mark(field);
+                    if(!contains(field)) {
+                        if(visitYoung(field)) own.push(field);
+                        return;
+                    }
+
+                    if(field->tryMark()) {
+                        markedBytes += field->size();
+                        ++markedCells;
+                        own.push(field);
+                    }
+                });
+            };
+
+            for(;;) {
+                while(auto obj = own.pop()) {
+                    scanFields(obj.value());
+                }
+
+                std::optional<GCObject*> stolen{};
+                for(size_t i = 1; i < threadCount && !stolen.has_value(); ++i) {
+                    stolen = deques[(id + i) % threadCount]->steal();
+                }
+
+                if(stolen.has_value()) {
+                    scanFields(stolen.value());
+                    continue;
+                }
+
+                // 只有拥有者会往队列里放任务, 所有线程都空闲时所有队列一定为空
+                active.fetch_sub(1);
+                for(;;) {
+                    if(active.load() == 0) {
+                        totalBytes.fetch_add(markedBytes);
+                        totalCells.fetch_add(markedCells);
+                        return;
+                    }
+
+                    if(std::ranges::any_of(deques, [](const auto& deque) { return !deque->empty(); })) {
+                        active.fetch_add(1);
+                        break;
+                    }
+
+                    std::this_thread::yield();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads{};
+        for(size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker, i);
         }
+        worker(0);
+
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        _markedBytes += totalBytes;
+        _markedCells += totalCells;
     }
 } // Ciallang
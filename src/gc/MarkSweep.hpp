@@ -14,35 +14,128 @@
 #pragma once
 
 #include "GC.hpp"
+#include "GCStats.hpp"
+#include "GCTracer.hpp"
+#include "ReferenceProcessor.hpp"
 
 namespace Ciallang::GC {
     static constexpr size_t NODE_SIZE = 128; // Byte
 
+    // 惰性清除的最小单位, 每次至少清除一页
+    static constexpr size_t PAGE_CELLS = 32;
+
+    // 单次清除增量的默认时间预算
+    static constexpr auto DEFAULT_SWEEP_BUDGET = std::chrono::microseconds{ 500 };
+
+    // 单次标记增量的默认时间预算
+    static constexpr auto DEFAULT_MARK_BUDGET = std::chrono::microseconds{ 500 };
+
+    // 每扫描这么多对象检查一次是否超出预算
+    static constexpr size_t MARK_CHECK_INTERVAL = 64;
+
+    /**
+     * 空闲时 next 串成空闲链表, 使用中 next 为 nullptr
+     */
     struct Cell {
         Cell* next{ nullptr };
         GCObject* data{ nullptr };
     };
 
+    /**
+     * 老年代由若干块连续的 cell 组成, 第一块由构造函数传入, 之后的由 grow 申请.
+     * 所有 cell 按块的顺序统一编号, firstIndex 是块中第一个 cell 的编号
+     */
+    struct Region {
+        Cell* head{ nullptr };
+        size_t firstIndex{};
+        size_t cellCount{};
+        bool owned{};
+
+        bool contains(const uintptr_t address) const noexcept {
+            const auto begin = reinterpret_cast<uintptr_t>(head);
+            return address >= begin && address < begin + cellCount * NODE_SIZE;
+        }
+    };
+
+    /**
+     * 三色增量标记: 白色 = 未标记, 灰色 = 已标记且在 _markStack 中, 黑色 = 已标记且已扫描.
+     * 标记期间的写操作需要经过 shade (Dijkstra 插入屏障), 结束前会重新扫描一次根集合.
+     * 新生代对象不标记也不回收, 但会经过它们追踪到老年代对象, 用 _youngVisited 去重.
+     * 新生代对象在置灰时立即扫描完, 不会留在 _markStack 中, 所以增量之间可以安全地执行 minor GC.
+     *
+     * 不限时的标记 (collect, finishMarking) 在 markThreads > 1 时由多个线程并行完成,
+     * 每个线程一个工作窃取队列.
+     *
+     * 标记后不立即清除整个堆, 而是在分配时按页惰性回收,
+     * 或者通过 sweepStep 在时间预算内增量回收.
+     * 开启 concurrentSweep 后由后台线程清除, 分配线程只在空闲链表为空时才同步清除一页.
+     * 页通过原子计数认领, 回收的 cell 先放入加锁的 _sweptList, 分配线程再整批取走.
+     *
+     * collect 结束标记时如果碎片率超过 compactThreshold, 改为整理 (双指针算法):
+     * 把高地址的存活对象搬到低地址的空闲 cell, 旧对象记录转发地址,
+     * 再通过 trace 更新根集合, 老年代, 新生代和记忆集中的引用.
+     * 增量标记 (markStep) 结束时只清除, 由调用方在可以移动对象时检查 compactPending.
+     *
+     * 标记结束时存活 cell 的比例超过 growOccupancy 就申请新的块, 让老年代容量翻倍;
+     * 整理后完全空闲的块会被释放. maxCells 限制 cell 的总数.
+     */
     class MarkSweep {
     public:
+        using Clock = std::chrono::steady_clock;
+
         explicit MarkSweep(Cell* heap, Cell* tail, std::vector<Roots*>& rootsSet);
 
+        ~MarkSweep();
+
+        MarkSweep(const MarkSweep&) = delete;
+        MarkSweep& operator=(const MarkSweep&) = delete;
+
+        // 完整地标记一次 (如果正在增量标记, 则把它做完), 然后进入惰性清除或者整理
         void collect();
 
+        // 扫描根集合, 开始增量标记
+        void startMarking();
+
+        // 在时间预算内标记, 返回是否已经标记完毕
+        bool markStep();
+
+        // 重新扫描根集合并标记完剩余的灰色对象, 然后进入惰性清除, 不会移动对象
+        void finishMarking();
+
+        // 完整地标记一次并整理老年代
+        void compact();
+
+        // 把对象置灰, 写屏障在标记期间调用
+        void shade(GCObject* obj);
+
+        // 新生代对象被移动后, 之前访问过的地址已经失效
+        void youngEvacuated() {
+            DCHECK(_youngStack.empty());
+            _youngVisited.clear();
+        }
+
+        // 记忆集中的老年代对象会被回收或者移动, 需要同步更新
+        void rememberedSet(std::vector<GCObject*>* rememberedSet) noexcept { _rememberedSet = rememberedSet; }
+
+        void references(ReferenceProcessor* references) noexcept { _references = references; }
+
+        [[nodiscard]] bool marking() const noexcept { return _marking; }
+
         template <typename T, typename... Args>
             requires is_gc_object_v<T>
         T* allocate(Args&&... args) {
-            if(!_nextFree || !_nextFree->data) {
-                findIdleNode();
-            }
-            Cell* cell = _nextFree;
+            static_assert(sizeof(Cell) + sizeof(T) <= NODE_SIZE, "object too large");
+
+            Cell* cell = findIdleNode();
 
             T* newObj = new(cell + 1) T(std::forward<Args>(args)...);
             newObj->marked(false);
-            newObj->size(sizeof(T));
 
             cell->data = newObj;
-            _nextFree = _nextFree->next;
+            _liveBytes += sizeof(T);
+
+            // 标记期间分配的对象直接置灰, 它引用的对象还需要扫描
+            if(_marking) shade(newObj);
 
             return newObj;
         }
@@ -50,45 +143,118 @@ namespace Ciallang::GC {
         template <typename T>
             requires is_gc_object_v<T>
         void reallocate(T*& obj) {
-            if(obj->size() > NODE_SIZE) {
+            if(sizeof(Cell) + obj->size() > NODE_SIZE) {
                 LOG(FATAL) << "object too large";
             }
 
-            if(!_nextFree || _nextFree->data) {
-                findIdleNode();
-            }
-
-            Cell* cell = _nextFree;
-
-            _nextFree = _nextFree->next;
+            Cell* cell = findIdleNode();
 
             auto* newObj = obj->copyTo(reinterpret_cast<uint8_t*>(cell + 1));
 
-            newObj->forwarded(false);
+            newObj->forwardTo(nullptr);
             newObj->marked(false);
 
             cell->data = newObj;
+            _liveBytes += newObj->size();
+
+            if(_marking) shade(newObj);
 
             obj = newObj;
         }
 
         Cell* findIdleNode();
 
+        // 清除剩余的所有页
         void sweep();
 
+        // 在时间预算内清除, 返回是否已经清除完毕
+        bool sweepStep();
+
+        [[nodiscard]] bool sweeping() const noexcept {
+            return _sweptPages.load(std::memory_order_acquire) < _pageCount.load(std::memory_order_acquire);
+        }
+
+        // 开启或关闭后台清除线程
+        void concurrentSweep(bool enable);
+
+        [[nodiscard]] bool concurrentSweep() const noexcept { return _sweeper.joinable(); }
+
         void mark(GCObject* obj);
 
-        uintptr_t start() const {
-            return reinterpret_cast<uintptr_t>(_head);
+        void markBudget(const std::chrono::microseconds budget) noexcept { _markBudget = budget; }
+
+        [[nodiscard]] std::chrono::microseconds markBudget() const noexcept { return _markBudget; }
+
+        void markThreads(const size_t threads) noexcept { _markThreads = std::max<size_t>(threads, 1); }
+
+        [[nodiscard]] size_t markThreads() const noexcept { return _markThreads; }
+
+        void sweepBudget(const std::chrono::microseconds budget) noexcept { _sweepBudget = budget; }
+
+        [[nodiscard]] std::chrono::microseconds sweepBudget() const noexcept { return _sweepBudget; }
+
+        // 碎片率达到这个值时整理, 0 表示从不整理
+        void compactThreshold(const double threshold) noexcept { _compactThreshold = threshold; }
+
+        [[nodiscard]] double compactThreshold() const noexcept { return _compactThreshold; }
+
+        // 上一次标记结束时, 最高的存活 cell 之下空闲 cell 的比例
+        [[nodiscard]] double fragmentation() const noexcept { return _fragmentation; }
+
+        // 上一次标记结束时碎片率达到了 compactThreshold, 但还没有整理
+        [[nodiscard]] bool compactPending() const noexcept {
+            return _compactThreshold > 0 && _fragmentation >= _compactThreshold;
         }
 
-        uintptr_t free() const {
-            if(!_nextFree) return start();
-            return reinterpret_cast<uintptr_t>(_nextFree);
+        // 标记后存活 cell 的比例达到这个值时扩容, 0 表示不自动扩容
+        void growOccupancy(const double occupancy) noexcept { _growOccupancy = occupancy; }
+
+        [[nodiscard]] double growOccupancy() const noexcept { return _growOccupancy; }
+
+        // cell 总数的上限, 0 表示不限制
+        void maxCells(const size_t cells) noexcept { _maxCells = cells; }
+
+        [[nodiscard]] size_t maxCells() const noexcept { return _maxCells; }
+
+        // 申请一块新的 cell, 返回实际增加的 cell 数, 超过上限时可能为 0
+        size_t grow(size_t cells);
+
+        [[nodiscard]] size_t regionCount() const noexcept { return _regions.size(); }
+
+        [[nodiscard]] const PauseStats& markPause() const noexcept { return _markPause; }
+
+        [[nodiscard]] const PauseStats& sweepPause() const noexcept { return _sweepPause; }
+
+        [[nodiscard]] const PauseStats& compactPause() const noexcept { return _compactPause; }
+
+        [[nodiscard]] size_t markCycles() const noexcept { return _markCycles; }
+
+        // 每次停顿都会记录到 tracer 中, nullptr 表示不记录
+        void tracer(GCTracer* tracer) noexcept { _tracer = tracer; }
+
+        [[nodiscard]] size_t freedBytes() const noexcept { return _freedBytes.load(std::memory_order_relaxed); }
+
+        // 上一次标记的存活字节数加上之后分配的字节数
+        [[nodiscard]] size_t liveBytes() const noexcept { return _liveBytes; }
+
+        // 包括已经死亡但还没有被清除的 cell
+        [[nodiscard]] size_t usedCells() const noexcept { return _usedCells.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] size_t cellCount() const noexcept { return _cellCount; }
+
+        [[nodiscard]] double occupancy() const noexcept {
+            return static_cast<double>(usedCells()) / static_cast<double>(_cellCount);
         }
 
-        uintptr_t end() const {
-            return reinterpret_cast<uintptr_t>(_tail);
+        [[nodiscard]] bool contains(const GCObject* obj) const noexcept {
+            const auto address = reinterpret_cast<uintptr_t>(obj);
+            return std::ranges::any_of(_regions, [&](const Region& region) {
+                return region.contains(address);
+            });
+        }
+
+        uintptr_t start() const {
+            return reinterpret_cast<uintptr_t>(_regions.front().head);
         }
 
         static constexpr size_t resolveHeapSize(const size_t size) {
@@ -114,8 +280,143 @@ namespace Ciallang::GC {
 
     private:
         std::vector<Roots*>& _rootsSet;
-        Cell* _nextFree{ nullptr };
-        Cell* _head{ nullptr };
-        Cell* _tail{ nullptr };
+
+        // 只有分配线程访问
+        Cell* _freeList{ nullptr };
+
+        // 按 firstIndex 排序, 只在没有清除任务时修改
+        std::vector<Region> _regions{};
+
+        // 清除线程回收的 cell
+        std::mutex _sweptLock{};
+        Cell* _sweptList{ nullptr };
+
+        std::atomic<size_t> _pageCount{};
+        // 下一个待认领的页
+        std::atomic<size_t> _nextSweepPage{};
+        // 已经清除完的页, 等于 _pageCount 时本轮清除结束
+        std::atomic<size_t> _sweptPages{};
+
+        std::thread _sweeper{};
+        std::mutex _sweeperLock{};
+        std::condition_variable _sweeperCond{};
+        std::atomic<bool> _sweeperStop{ false };
+        // 每开始一轮清除加一, 唤醒后台线程
+        size_t _sweepEpoch{};
+
+        std::chrono::microseconds _sweepBudget{ DEFAULT_SWEEP_BUDGET };
+        std::chrono::microseconds _markBudget{ DEFAULT_MARK_BUDGET };
+
+        bool _marking{ false };
+
+        size_t _markThreads{ 1 };
+
+        // 灰色对象
+        std::vector<GCObject*> _markStack{};
+
+        // 本轮标记中已经扫描过的新生代对象
+        std::mutex _youngLock{};
+        std::unordered_set<GCObject*> _youngVisited{};
+
+        // 等待扫描的新生代对象, 在 shade 返回前清空
+        std::vector<GCObject*> _youngStack{};
+        bool _scanningYoung{ false };
+
+        std::vector<GCObject*>* _rememberedSet{ nullptr };
+
+        ReferenceProcessor* _references{ nullptr };
+
+        size_t _markedBytes{};
+        size_t _markedCells{};
+        size_t _liveBytes{};
+
+        double _compactThreshold{};
+        double _fragmentation{};
+
+        double _growOccupancy{};
+        size_t _maxCells{};
+
+        std::atomic<size_t> _usedCells{};
+        size_t _cellCount{};
+
+        PauseStats _markPause{};
+        PauseStats _sweepPause{};
+        PauseStats _compactPause{};
+        size_t _markCycles{};
+
+        GCTracer* _tracer{ nullptr };
+        std::atomic<size_t> _freedBytes{};
+
+        // 重新扫描根集合, 标记完剩余的灰色对象并统计存活字节和碎片率
+        void completeMarking();
+
+        // 开始新一轮惰性清除
+        void startSweep();
+
+        // 搬移存活对象并更新所有引用, 然后重建空闲链表
+        void evacuate();
+
+        void recordPause(PauseStats& stats, const char* name, Clock::time_point begin, GCTracer::Args&& args = {});
+
+        // 按存活比例扩容, 在标记结束后调用
+        void growIfNeeded();
+
+        // 释放 liveCells 之后完全空闲的块, 在整理后调用
+        void shrink(size_t liveCells);
+
+        // cell 数量变化后重新计算页数, 此时不能有清除任务
+        void resetPages();
+
+        // 第一次访问这个新生代对象时返回 true
+        bool visitYoung(GCObject* obj);
+
+        // 扫描 _youngStack 中的新生代对象, 直到它为空
+        void scanYoung();
+
+        // 按需清除, 直到空闲链表不为空或者清除完毕
+        void lazySweep();
+
+        // 认领并清除下一页, 没有可认领的页时返回 false
+        bool sweepNextPage();
+
+        // 取走清除线程回收的 cell
+        void takeSweptCells();
+
+        // 等待其他线程正在清除的页完成
+        void waitSweepDone() const;
+
+        void backgroundSweep();
+
+        void scanRoots();
+
+        // 标记结束后清除弱引用, 复活需要终结的对象
+        void processReferences();
+
+        // 扫描对象的所有字段, 把它们置灰
+        void scan(GCObject* obj);
+
+        // 标记灰色对象直到 _markStack 为空或者超过 deadline, 返回 _markStack 是否为空
+        bool drain(std::optional<Clock::time_point> deadline);
+
+        // 多线程标记完所有灰色对象
+        void drainParallel();
+
+        Cell* cellAt(const size_t index) const {
+            const Region* region = &_regions.front();
+            if(index >= region->cellCount) {
+                region = &*std::prev(std::ranges::upper_bound(
+                    _regions, index, {}, &Region::firstIndex
+                ));
+            }
+
+            return reinterpret_cast<Cell*>(
+                reinterpret_cast<uint8_t*>(region->head) + (index - region->firstIndex) * NODE_SIZE
+            );
+        }
+
+        bool liveAt(const size_t index) const {
+            const Cell* cell = cellAt(index);
+            return cell->data && cell->data->marked();
+        }
     };
 } // Ciallang
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024/10/21 下午3:40
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "PermSpace.hpp"
+
+namespace Ciallang::GC {
+    PermSpace::PermSpace(const size_t chunkSize) : _chunkSize(chunkSize) {
+    }
+
+    PermSpace::~PermSpace() {
+        for(auto* obj : _objects) {
+            obj->~GCObject();
+        }
+
+        for(auto& chunk : _chunks) {
+            free(chunk.memory);
+        }
+    }
+
+    bool PermSpace::contains(const GCObject* obj) const {
+        const auto* address = reinterpret_cast<const uint8_t*>(obj);
+
+        std::lock_guard lock{ _lock };
+        return std::ranges::any_of(_chunks, [&](const Chunk& chunk) {
+            return address >= chunk.memory && address < chunk.memory + chunk.size;
+        });
+    }
+
+    uint8_t* PermSpace::allocateRaw(const size_t size, const size_t align) {
+        auto alignUp = [&](uint8_t* address) {
+            const auto value = reinterpret_cast<uintptr_t>(address);
+            return reinterpret_cast<uint8_t*>((value + align - 1) / align * align);
+        };
+
+        uint8_t* memory = alignUp(_top);
+        if(!_top || memory + size > _end) {
+            // malloc 的结果满足 max_align_t 对齐
+            const size_t chunkSize = std::max(_chunkSize, size);
+            auto* chunk = static_cast<uint8_t*>(malloc(chunkSize));
+            CHECK_NOTNULL(chunk);
+
+            _chunks.push_back({ chunk, chunkSize });
+            _capacity += chunkSize;
+            _end = chunk + chunkSize;
+            memory = chunk;
+        }
+
+        _top = memory + size;
+        _usedBytes += size;
+        return memory;
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2024/10/21 下午3:40
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "GC.hpp"
+
+namespace Ciallang::GC {
+    // 永久区每次向系统申请的块大小, 更大的对象单独占用一个块
+    static constexpr size_t PERM_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * 永久区: 存放宿主分配的不会死亡的 GCObject
+     *
+     * 解释器的 TjsValue 对象目前还不由回收器管理, TjsStringTable 的驻留字符串和 Chunk 的常量
+     * 仍然在 C++ 堆上, 它们改为 GCObject 之后再从这里分配.
+     *
+     * 按块向系统申请内存, 块内只移动指针分配, 对象不会移动也不会被回收,
+     * 回收器既不标记也不扫描永久区的对象, 所以永久区的对象只能引用永久区的对象.
+     * 对象的析构函数在永久区析构时统一调用
+     *
+     * freeze 之后永久区变为只读, 不能再分配,
+     * 可以通过 shared_ptr 在多个解释器实例 (多个 Generational) 之间共享
+     */
+    class PermSpace {
+    public:
+        explicit PermSpace(size_t chunkSize = PERM_CHUNK_SIZE);
+
+        ~PermSpace();
+
+        PermSpace(const PermSpace&) = delete;
+        PermSpace& operator=(const PermSpace&) = delete;
+
+        template <typename T, typename... Args>
+            requires is_gc_object_v<T>
+        T* allocate(Args&&... args) {
+            std::lock_guard lock{ _lock };
+            CHECK(!frozen()) << "Perm space is frozen";
+
+            T* obj = new(allocateRaw(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            obj->perm(true);
+            _objects.push_back(obj);
+            return obj;
+        }
+
+        // 之后只能读取, 多个堆共享前调用
+        void freeze() noexcept { _frozen.store(true, std::memory_order_release); }
+        [[nodiscard]] bool frozen() const noexcept { return _frozen.load(std::memory_order_acquire); }
+
+        [[nodiscard]] bool contains(const GCObject* obj) const;
+
+        [[nodiscard]] size_t usedBytes() const noexcept { return _usedBytes; }
+        [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+        [[nodiscard]] size_t objectCount() const noexcept { return _objects.size(); }
+
+    private:
+        struct Chunk {
+            uint8_t* memory;
+            size_t size;
+        };
+
+        mutable std::mutex _lock{};
+
+        std::vector<Chunk> _chunks{};
+        std::vector<GCObject*> _objects{};
+
+        uint8_t* _top{ nullptr };
+        uint8_t* _end{ nullptr };
+
+        size_t _chunkSize;
+        size_t _usedBytes{};
+        size_t _capacity{};
+
+        std::atomic<bool> _frozen{};
+
+        uint8_t* allocateRaw(size_t size, size_t align);
+    };
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024/10/23 下午7:52
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "ReferenceProcessor.hpp"
+
+namespace Ciallang::GC {
+    WeakRef* ReferenceProcessor::createWeakRef(GCObject* target) {
+        std::lock_guard lock{ _lock };
+        _weakRefs.push_back(std::make_unique<WeakRef>(target));
+        return _weakRefs.back().get();
+    }
+
+    void ReferenceProcessor::releaseWeakRef(const WeakRef* ref) {
+        std::lock_guard lock{ _lock };
+        std::erase_if(_weakRefs, [&](const auto& weakRef) {
+            return weakRef.get() == ref;
+        });
+    }
+
+    void ReferenceProcessor::registerFinalizer(GCObject* obj) {
+        CHECK(!obj->perm()) << "Perm objects are never finalized";
+
+        std::lock_guard lock{ _lock };
+        _finalizable.push_back(obj);
+    }
+
+    void ReferenceProcessor::processWeakRefs(const Forwarder& forward) {
+        for(auto& ref : _weakRefs) {
+            if(!ref->_target) continue;
+
+            ref->_target = forward(ref->_target);
+            if(!ref->_target) ++_clearedWeakRefs;
+        }
+    }
+
+    void ReferenceProcessor::processFinalizers(const Forwarder& forward, const FieldVisitor& resurrect) {
+        size_t index = 0;
+        while(index < _finalizable.size()) {
+            GCObject*& obj = _finalizable[index];
+
+            if(GCObject* live = forward(obj)) {
+                obj = live;
+                ++index;
+                continue;
+            }
+
+            GCObject* dead = obj;
+            obj = _finalizable.back();
+            _finalizable.pop_back();
+
+            resurrect(dead);
+            _pending.push_back(dead);
+        }
+    }
+
+    void ReferenceProcessor::update(const FieldVisitor& visitor) {
+        for(auto& ref : _weakRefs) {
+            if(ref->_target) visitor(ref->_target);
+        }
+
+        for(auto& obj : _finalizable) {
+            visitor(obj);
+        }
+    }
+
+    size_t ReferenceProcessor::runFinalizers() {
+        size_t count = 0;
+
+        // 终结器执行完才出队, 执行期间对象仍然是根
+        while(!_pending.empty()) {
+            _pending.back()->finalize();
+            _pending.pop_back();
+            ++count;
+        }
+
+        _finalizedObjects += count;
+        return count;
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024/10/23 下午7:52
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "GC.hpp"
+
+namespace Ciallang::GC {
+    /**
+     * 弱引用, 不会让目标存活. 目标被回收后 get 返回 nullptr,
+     * 目标被移动后回收器会更新弱引用
+     *
+     * 弱引用本身不在堆上, 由 ReferenceProcessor 持有
+     */
+    class WeakRef {
+    public:
+        explicit WeakRef(GCObject* target) noexcept : _target(target) {
+        }
+
+        [[nodiscard]] GCObject* get() const noexcept { return _target; }
+
+        template <typename T>
+            requires is_gc_object_v<T>
+        [[nodiscard]] T* get() const noexcept { return static_cast<T*>(_target); }
+
+        [[nodiscard]] bool cleared() const noexcept { return _target == nullptr; }
+
+    private:
+        friend class ReferenceProcessor;
+
+        GCObject* _target;
+    };
+
+    /**
+     * 管理弱引用和需要终结的对象
+     *
+     * 回收器在标记或复制结束后先清除指向死亡对象的弱引用,
+     * 再把死亡的可终结对象复活一轮并放入待终结队列.
+     * 待终结队列是一个根集合, 终结器在安全点执行后对象才成为普通的垃圾
+     */
+    class ReferenceProcessor {
+    public:
+        // 返回对象存活后的地址, 死亡返回 nullptr, 不在本次回收范围内的对象原样返回
+        using Forwarder = std::function<GCObject*(GCObject*)>;
+
+        explicit ReferenceProcessor(Roots& pending) : _pending(pending) {
+        }
+
+        WeakRef* createWeakRef(GCObject* target);
+
+        void releaseWeakRef(const WeakRef* ref);
+
+        // 对象死亡后调用一次它的 finalize
+        void registerFinalizer(GCObject* obj);
+
+        // 回收器调用
+        void processWeakRefs(const Forwarder& forward);
+
+        // resurrect 需要让对象和它引用的对象存活, 并可以改写对象的地址
+        void processFinalizers(const Forwarder& forward, const FieldVisitor& resurrect);
+
+        // 移动对象的回收器更新所有引用
+        void update(const FieldVisitor& visitor);
+
+        // 执行待终结队列中的终结器, 返回执行的数量
+        size_t runFinalizers();
+
+        [[nodiscard]] size_t weakRefCount() const noexcept { return _weakRefs.size(); }
+        [[nodiscard]] size_t finalizableCount() const noexcept { return _finalizable.size(); }
+        [[nodiscard]] size_t pendingCount() const noexcept { return _pending.size(); }
+
+        [[nodiscard]] size_t clearedWeakRefs() const noexcept { return _clearedWeakRefs; }
+        [[nodiscard]] size_t finalizedObjects() const noexcept { return _finalizedObjects; }
+
+    private:
+        std::mutex _lock{};
+
+        std::vector<std::unique_ptr<WeakRef>> _weakRefs{};
+
+        std::vector<GCObject*> _finalizable{};
+
+        Roots& _pending;
+
+        size_t _clearedWeakRefs{};
+        size_t _finalizedObjects{};
+    };
+}
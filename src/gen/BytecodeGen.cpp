@@ -20,11 +20,104 @@
 #include "vm/Instruction.hpp"
 
 namespace Ciallang::Inter {
+    namespace {
+        // 收集声明或赋值过的名字, 不区分作用域, 宁可少内联也不能内联错
+        class DefinitionCollector final : public Syntax::AstNode::Visitor {
+        public:
+            std::unordered_set<TjsInternedString> definitions{};
+
+            void visit(const Syntax::StmtDeclNode* node) override {
+                node->statement->accept(this);
+            }
+
+            void visit(const Syntax::VarDeclNode* node) override {
+                definitions.insert(node->token->identifier());
+                if(node->rhs) node->rhs->accept(this);
+            }
+
+            void visit(const Syntax::FunctionDeclNode* node) override {
+                definitions.insert(node->token->identifier());
+                for(auto& [token, exprNode] : node->parameters) {
+                    if(exprNode) exprNode->accept(this);
+                }
+                node->body->accept(this);
+            }
+
+            void visit(const Syntax::ValueExprNode*) override {
+            }
+
+            void visit(const Syntax::IdentifierExprNode*) override {
+            }
+
+            void visit(const Syntax::BinaryExprNode* node) override {
+                node->lhs->accept(this);
+                node->rhs->accept(this);
+            }
+
+            void visit(const Syntax::UnaryExprNode* node) override {
+                node->rhs->accept(this);
+            }
+
+            void visit(const Syntax::ProcCallExprNode* node) override {
+                node->memberAccess->accept(this);
+                for(const auto* exprNode : node->arguments) {
+                    if(exprNode) exprNode->accept(this);
+                }
+            }
+
+            void visit(const Syntax::AssignExprNode* node) override {
+                if(dynamic_cast<const Syntax::IdentifierExprNode*>(node->lhs)) {
+                    definitions.insert(node->lhs->token->identifier());
+                }
+                node->lhs->accept(this);
+                node->rhs->accept(this);
+            }
+
+            void visit(const Syntax::BlockStmtNode* node) override {
+                for(const auto* child : node->childrens) {
+                    child->accept(this);
+                }
+            }
+
+            void visit(const Syntax::ExprStmtNode* node) override {
+                node->expression->accept(this);
+            }
+
+            void visit(const Syntax::IfStmtNode* node) override {
+                node->test->accept(this);
+                node->body->accept(this);
+                if(node->elseBody) node->elseBody->accept(this);
+            }
+
+            void visit(const Syntax::WhileStmtNode* node) override {
+                node->test->accept(this);
+                node->body->accept(this);
+            }
+
+            void visit(const Syntax::BreakStmtNode*) override {
+            }
+
+            void visit(const Syntax::ContinueStmtNode*) override {
+            }
+
+            void visit(const Syntax::ReturnStmtNode* node) override {
+                if(node->expr) node->expr->accept(this);
+            }
+        };
+    }
+
     std::unique_ptr<Bytecode::Chunk> BytecodeGen::parseAst(
         const Common::Result& r,
         const Syntax::AstNode* node
     ) {
         _r = r;
+        if(!_definitions) {
+            DefinitionCollector collector{};
+            node->accept(&collector);
+            _definitions = std::make_shared<const std::unordered_set<TjsInternedString>>(
+                std::move(collector.definitions)
+            );
+        }
         _chunk = new Bytecode::Chunk{};
         node->generateBytecode(this);
         if(_r.isFailed()) return nullptr;
@@ -39,7 +132,9 @@ namespace Ciallang::Inter {
 
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::ValueExprNode* node) {
         auto dst = allocateRegister();
-        _chunk->emit<Bytecode::Op::Load>(dst, std::move(*node->token->value()));
+        // 复合赋值会再次生成左侧的节点, 常量不能移走; 省略的参数没有值, 为 void
+        const auto* value = node->token->value();
+        _chunk->emit<Bytecode::Op::Load>(dst, value ? TjsValue{ *value } : TjsValue{});
 
         if(_r.isFailed()) return {};
         return dst;
@@ -47,6 +142,34 @@ namespace Ciallang::Inter {
 
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::BinaryExprNode* node) {
         using enum Syntax::TokenType;
+
+        // obj.name 编译为直接属性读取, name 不作为表达式求值
+        if(node->token->type() == Dot) {
+            auto* name = memberName(node);
+            if(!name) return {};
+
+            auto obj = node->lhs->generateBytecode(this);
+            if(_r.isFailed()) return {};
+            CHECK(obj.has_value());
+
+            auto dst = allocateRegister();
+            _chunk->emit<Bytecode::Op::GPD>(dst, obj.value(), name->token->identifier());
+            return dst;
+        }
+
+        // obj[index], 下标在运行时求值
+        if(node->token->type() == LBracket) {
+            auto obj = node->lhs->generateBytecode(this);
+            auto index = node->rhs->generateBytecode(this);
+            if(_r.isFailed()) return {};
+            CHECK(obj.has_value());
+            CHECK(index.has_value());
+
+            auto dst = allocateRegister();
+            _chunk->emit<Bytecode::Op::GPI>(dst, obj.value(), index.value());
+            return dst;
+        }
+
         auto reg1 = node->lhs->generateBytecode(this);
         auto reg2 = node->rhs->generateBytecode(this);
         auto dst = allocateRegister();
@@ -102,23 +225,51 @@ namespace Ciallang::Inter {
 
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::ProcCallExprNode* node) {
         auto* member = node->memberAccess;
+
+        if(const auto* intrinsic = dynamic_cast<const Syntax::IdentifierExprNode*>(member)
+                                       ? resolveIntrinsic(node, member->token->identifier())
+                                       : nullptr) {
+            std::vector<Bytecode::Register> arguments{};
+            for(const auto* exprNode : node->arguments) {
+                auto reg = exprNode->generateBytecode(this);
+                if(_r.isFailed()) return {};
+
+                CHECK(reg.has_value());
+                arguments.push_back(reg.value());
+            }
+
+            // 退回普通调用时需要结果寄存器, 没有结果的内建函数也分配
+            const auto dst = allocateRegister();
+            intrinsic->emit(*_chunk, member->token->identifier(), arguments.data(), dst);
+            return dst;
+        }
+
         auto dst = allocateRegister();
 
         if(dynamic_cast<const Syntax::IdentifierExprNode*>(member)) {
-            std::vector<Bytecode::Register> arguments{};
             auto memberReg = node->memberAccess->generateBytecode(this);
-            for(auto* exprNode : node->arguments) {
+
+            const auto count = static_cast<std::uint32_t>(node->arguments.size());
+            const auto first = allocateRegisters(count);
+            for(std::uint32_t i = 0; i < count; i++) {
+                auto* exprNode = node->arguments[i];
+                std::optional<Bytecode::Register> reg{};
                 if(!exprNode) {
-                    arguments.push_back(getEmpty(*_chunk));
+                    reg = getEmpty(*_chunk);
                 } else {
-                    auto reg = exprNode->generateBytecode(this);
+                    reg = exprNode->generateBytecode(this);
                     if(_r.isFailed()) return {};
 
                     CHECK(reg.has_value());
-                    arguments.push_back(reg.value());
+                }
+
+                // 局部变量和表达式结果可能落在任意寄存器, 搬到参数块里
+                const Bytecode::Register slot{ first.index() + i };
+                if(reg->index() != slot.index()) {
+                    _chunk->emit<Bytecode::Op::Mov>(reg.value(), slot);
                 }
             }
-            _chunk->emit<Bytecode::Op::Call>(dst, memberReg.value(), std::move(arguments));
+            _chunk->emit<Bytecode::Op::Call>(dst, memberReg.value(), first, count);
             return dst;
         }
         DCHECK(true) << "no impl";
@@ -127,12 +278,41 @@ namespace Ciallang::Inter {
 
 
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::AssignExprNode* node) {
-        // TODO: member access
-        auto identifier = node->lhs->token->value();
+        // obj[index] = value
+        if(const auto* member = dynamic_cast<const Syntax::BinaryExprNode*>(node->lhs);
+            member && member->token->type() == Syntax::TokenType::LBracket) {
+            auto obj = member->lhs->generateBytecode(this);
+            auto index = member->rhs->generateBytecode(this);
+            auto src = node->rhs->generateBytecode(this);
+            if(_r.isFailed()) return {};
+            CHECK(obj.has_value());
+            CHECK(index.has_value());
+            CHECK(src.has_value());
 
-        DCHECK(identifier->isString());
+            _chunk->emit<Bytecode::Op::SPI>(obj.value(), index.value(), src.value(), true);
+            return src;
+        }
+
+        // obj.name = value, 成员不存在时添加
+        if(const auto* member = dynamic_cast<const Syntax::BinaryExprNode*>(node->lhs)) {
+            auto* name = memberName(member);
+            if(!name) return {};
 
-        auto variable = resolveLocalVariable(*identifier->asString());
+            auto obj = member->lhs->generateBytecode(this);
+            auto src = node->rhs->generateBytecode(this);
+            if(_r.isFailed()) return {};
+            CHECK(obj.has_value());
+            CHECK(src.has_value());
+
+            _chunk->emit<Bytecode::Op::SPD>(obj.value(), name->token->identifier(), src.value(), true);
+            return src;
+        }
+
+        const auto identifier = node->lhs->token->identifier();
+
+        DCHECK(identifier);
+
+        auto variable = resolveLocalVariable(identifier);
 
         if(variable.has_value()) {
             auto dst = node->lhs->generateBytecode(this);
@@ -150,37 +330,33 @@ namespace Ciallang::Inter {
         auto src = node->rhs->generateBytecode(this);
         DCHECK(src.has_value());
 
-        _chunk->emit<Bytecode::Op::DGlobal>(std::move(*identifier->asString()), src.value());
+        _chunk->emit<Bytecode::Op::DGlobal>(identifier, src.value());
 
         if(_r.isFailed()) return {};
         return src;
     }
 
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::VarDeclNode* node) {
-        auto identifier = node->token->value();
+        const auto identifier = node->token->identifier();
 
-        DCHECK(identifier->isString());
+        DCHECK(identifier);
 
         // global
         if(_scopeDepth == 1) {
             // can't init
             if(!node->rhs) {
-                _chunk->emit<Bytecode::Op::DGlobal>(
-                    std::move(*identifier->asString()), getEmpty(*_chunk)
-                );
+                _chunk->emit<Bytecode::Op::DGlobal>(identifier, getEmpty(*_chunk));
                 return {};
             }
 
             auto src = node->rhs->generateBytecode(this);
             if(_r.isFailed()) return {};
 
-            _chunk->emit<Bytecode::Op::DGlobal>(
-                std::move(*identifier->asString()), src.value()
-            );
+            _chunk->emit<Bytecode::Op::DGlobal>(identifier, src.value());
             return {};
         }
 
-        auto variable = resolveLocalVariable(*identifier->asString());
+        auto variable = resolveLocalVariable(identifier);
 
         // already have this variable, in same scope
         if(variable.has_value()) {
@@ -210,22 +386,21 @@ namespace Ciallang::Inter {
             dst = getEmpty(*_chunk);
         }
 
-        _variables.emplace_back(
-            std::move(*identifier->asString()),
-            dst.value(), _scopeDepth, !!node->rhs
-        );
+        _variables.emplace_back(identifier, dst.value(), _scopeDepth, !!node->rhs);
 
         return {};
     }
 
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::FunctionDeclNode* node) {
         auto gen = BytecodeGen{ _sourceFile };
+        gen._definitions = _definitions;
+        gen._intrinsics = _intrinsics;
 
         for(auto& [token, exprNode] : node->parameters) {
-            auto varName = token.value();
+            const auto varName = token.identifier();
             std::optional<Bytecode::Register> paramReg{};
 
-            CHECK(varName->isString());
+            CHECK(varName);
 
             if(exprNode) {
                 auto defaultParameter = exprNode->generateBytecode(&gen);
@@ -236,7 +411,7 @@ namespace Ciallang::Inter {
             }
 
             gen.addVariable(LocalVariable{
-                    *varName->asString(),
+                    varName,
                     paramReg.value(),
                     1,
                     true
@@ -251,35 +426,32 @@ namespace Ciallang::Inter {
             funChunk->emit<Bytecode::Op::Ret>(gen.getEmpty(*funChunk));
         }
 
-        auto identifier = node->token->value();
+        const auto identifier = node->token->identifier();
 
-        CHECK(identifier->isString());
+        CHECK(identifier);
 
         if(_scopeDepth == 1) {
             _chunk->emit<Bytecode::Op::Load>(funReg, TjsValue{ TjsFunction{
                             std::move(*funChunk.release()),
-                            *identifier->asString(),
+                            identifier.str(),
                             node->parameters.size()
                     }
             });
 
-            _chunk->emit<Bytecode::Op::DGlobal>(
-                std::move(*identifier->asString()),
-                funReg
-            );
+            _chunk->emit<Bytecode::Op::DGlobal>(identifier, funReg);
             freeRegister(funReg);
             return {};
         }
 
         _chunk->emit<Bytecode::Op::Load>(funReg, TjsValue{ TjsFunction{
                         std::move(*funChunk.release()),
-                        *identifier->asString(),
+                        identifier.str(),
                         node->parameters.size()
                 }
         });
 
         _variables.push_back(LocalVariable{
-                *identifier->asString(),
+                identifier,
                 funReg,
                 _scopeDepth,
                 true
@@ -290,11 +462,11 @@ namespace Ciallang::Inter {
 
 
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::IdentifierExprNode* node) {
-        auto identifier = node->token->value();
+        const auto identifier = node->token->identifier();
 
-        DCHECK(identifier->isString());
+        DCHECK(identifier);
 
-        auto variable = resolveLocalVariable(*identifier->asString());
+        auto variable = resolveLocalVariable(identifier);
 
         if(variable.has_value()) {
             if(!variable.value()->init) {
@@ -305,12 +477,23 @@ namespace Ciallang::Inter {
         }
 
         auto dst = allocateRegister();
-        _chunk->emit<Bytecode::Op::GGlobal>(std::move(*identifier->asString()), dst);
+        _chunk->emit<Bytecode::Op::GGlobal>(identifier, dst);
         if(_r.isFailed()) return {};
 
         return dst;
     }
 
+    const Syntax::IdentifierExprNode* BytecodeGen::memberName(const Syntax::BinaryExprNode* node) {
+        const auto* name = dynamic_cast<const Syntax::IdentifierExprNode*>(node->rhs);
+        if(!name) {
+            error(_r, "member access expects identifier", node->rhs->location);
+            return nullptr;
+        }
+
+        DCHECK(name->token->identifier());
+        return name;
+    }
+
     std::optional<Bytecode::Register> BytecodeGen::generate(const Syntax::StmtDeclNode* node) {
         return node->statement->generateBytecode(this);
     }
@@ -390,7 +573,7 @@ namespace Ciallang::Inter {
         return {};
     }
 
-    std::optional<LocalVariable*> BytecodeGen::resolveLocalVariable(const std::string& identifier) {
+    std::optional<LocalVariable*> BytecodeGen::resolveLocalVariable(const TjsInternedString identifier) {
         for(auto& variable : _variables) {
             if(variable.identifier == identifier
                && variable.scopeDepth <= _scopeDepth) {
@@ -399,4 +582,19 @@ namespace Ciallang::Inter {
         }
         return {};
     }
+
+    const Intrinsic* BytecodeGen::resolveIntrinsic(
+        const Syntax::ProcCallExprNode* node,
+        const TjsInternedString identifier
+    ) {
+        if(!_intrinsics || !_definitions || _definitions->contains(identifier)) return nullptr;
+        if(resolveLocalVariable(identifier).has_value()) return nullptr;
+
+        const auto* intrinsic = findIntrinsic(identifier);
+        if(!intrinsic || intrinsic->arity != node->arguments.size()) return nullptr;
+
+        // 省略的参数走普通调用
+        if(std::ranges::find(node->arguments, nullptr) != node->arguments.end()) return nullptr;
+        return intrinsic;
+    }
 }
@@ -15,6 +15,7 @@
 #include "pch.h"
 
 #include "ast/Ast.hpp"
+#include "gen/Intrinsic.hpp"
 #include "vm/Chunk.hpp"
 #include "vm/Register.hpp"
 #include "common/Result.hpp"
@@ -23,7 +24,7 @@
 
 namespace Ciallang::Inter {
     struct LocalVariable {
-        std::string identifier;
+        TjsInternedString identifier;
         Bytecode::Register reg;
         size_t scopeDepth;
         bool init;
@@ -45,6 +46,12 @@ namespace Ciallang::Inter {
             _sourceFile.error(r, message, location);
         }
 
+        // 调用内建函数时是否生成专用指令, 关闭后全部走 call.
+        // 专用指令会检查全局变量是否仍是内建函数, 宿主替换同名全局函数不需要关闭
+        void enableIntrinsics(const bool enable) {
+            _intrinsics = enable;
+        }
+
         void addVariable(LocalVariable&& variable) {
             _variables.push_back(std::move(variable));
         }
@@ -100,6 +107,10 @@ namespace Ciallang::Inter {
 
         std::optional<Bytecode::Register> _empty{};
 
+        // 整个编译单元里声明或赋值过的名字, 函数体共用; 同名的内建函数不再内联
+        std::shared_ptr<const std::unordered_set<TjsInternedString>> _definitions{};
+        bool _intrinsics{ true };
+
         Bytecode::Register allocateRegister() {
             if(!_freeRegisters.empty()) {
                 const Bytecode::Register reg = _freeRegisters.back();
@@ -110,10 +121,20 @@ namespace Ciallang::Inter {
             return Bytecode::Register{ _nextIndex++ };
         }
 
+        // 连续的 count 个寄存器, 不从空闲列表取, 调用参数要求连续
+        Bytecode::Register allocateRegisters(const std::uint32_t count) {
+            const Bytecode::Register first{ _nextIndex };
+            _nextIndex += count;
+            return first;
+        }
+
         void freeRegister(const Bytecode::Register reg) {
             _freeRegisters.push_back(reg);
         }
 
+        // 成员访问 obj.name 中的 name
+        const Syntax::IdentifierExprNode* memberName(const Syntax::BinaryExprNode* node);
+
         Bytecode::Label makeLabel() const {
             return Bytecode::Label{ _chunk->instructions().size() };
         }
@@ -142,6 +163,8 @@ namespace Ciallang::Inter {
             return _empty.value();
         }
 
-        std::optional<LocalVariable*> resolveLocalVariable(const std::string& identifier);
+        std::optional<LocalVariable*> resolveLocalVariable(TjsInternedString identifier);
+
+        const Intrinsic* resolveIntrinsic(const Syntax::ProcCallExprNode* node, TjsInternedString identifier);
     };
 }
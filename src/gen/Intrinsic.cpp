@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024/10/23 上午11:02
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#include "Intrinsic.hpp"
+
+#include "vm/Instruction.hpp"
+
+namespace Ciallang::Inter {
+    using Bytecode::Chunk;
+    using Bytecode::Register;
+
+    static constinit auto S_Intrinsics =
+            frozen::make_unordered_map<frozen::string, Intrinsic>({
+                    {
+                        "print", { 1, [](Chunk& chunk, const TjsInternedString name, const Register* arguments, const Register dst) {
+                            chunk.emit<Bytecode::Op::Print>(name, arguments[0], dst, false);
+                        } }
+                    },
+                    {
+                        "println", { 1, [](Chunk& chunk, const TjsInternedString name, const Register* arguments, const Register dst) {
+                            chunk.emit<Bytecode::Op::Print>(name, arguments[0], dst, true);
+                        } }
+                    },
+                    {
+                        "mathAbs", { 1, [](Chunk& chunk, const TjsInternedString name, const Register* arguments, const Register dst) {
+                            chunk.emit<Bytecode::Op::MathAbs>(name, arguments[0], dst);
+                        } }
+                    },
+                    {
+                        "mathMin", { 2, [](Chunk& chunk, const TjsInternedString name, const Register* arguments, const Register dst) {
+                            chunk.emit<Bytecode::Op::MathMin>(name, arguments[0], arguments[1], dst);
+                        } }
+                    },
+                    {
+                        "mathMax", { 2, [](Chunk& chunk, const TjsInternedString name, const Register* arguments, const Register dst) {
+                            chunk.emit<Bytecode::Op::MathMax>(name, arguments[0], arguments[1], dst);
+                        } }
+                    }
+            });
+
+    const Intrinsic* findIntrinsic(const TjsInternedString identifier) {
+        const auto view = identifier.view();
+        const auto it = S_Intrinsics.find(frozen::string{ view.data(), view.size() });
+        return it == S_Intrinsics.end() ? nullptr : &it->second;
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2024/10/23 上午11:02
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "vm/Chunk.hpp"
+#include "vm/Register.hpp"
+
+#include "types/TjsStringTable.hpp"
+
+namespace Ciallang::Inter {
+    /**
+     * 内建函数的内联表
+     * 调用脚本中没有定义的内建函数, 且参数个数正好等于 arity 时, 不走 call, 直接生成专用指令.
+     * 专用指令只有在全局变量仍是宿主注册的内建函数时才走快速路径,
+     * 宿主替换了它 (例如自己的 println) 或者没有注册时按普通调用执行, 结果与关闭内联时相同
+     */
+    struct Intrinsic {
+        uint32_t arity;
+
+        // arguments 是已经求值的 arity 个参数寄存器, name 是被调用的全局变量
+        void (*emit)(Bytecode::Chunk& chunk,
+                     TjsInternedString name,
+                     const Bytecode::Register* arguments,
+                     Bytecode::Register dst);
+    };
+
+    const Intrinsic* findIntrinsic(TjsInternedString identifier);
+}
@@ -83,33 +83,41 @@ std::multimap<int32_t, Lexer::LexerCaseCallable> Lexer::S_Cases{
     return nullptr;
 }();
 
-std::unordered_map<std::string, const Token&> Lexer::S_Keywords{
-        { "true", S_True },
-        { "false", S_False },
-        { "Infinity", S_Infinity },
-        { "NaN", S_NaN },
+Ciallang::Collections::FlatHashMap<Ciallang::TjsInternedString, const Token*> Lexer::S_Keywords = [] {
+    const std::pair<std::string_view, const Token*> keywords[]{
+            { "true", &S_True },
+            { "false", &S_False },
+            { "Infinity", &S_Infinity },
+            { "NaN", &S_NaN },
 
-        { "function", S_Function },
-        { "return", S_Return },
+            { "function", &S_Function },
+            { "return", &S_Return },
 
-        { "var", S_Var },
-        { "const", S_Const },
+            { "var", &S_Var },
+            { "const", &S_Const },
 
-        { "if", S_If },
-        { "else", S_Else },
+            { "if", &S_If },
+            { "else", &S_Else },
 
-        { "int", S_Int },
-        { "real", S_Real },
-        { "string", S_String },
+            { "int", &S_Int },
+            { "real", &S_Real },
+            { "string", &S_String },
 
-        { "new", S_New },
+            { "new", &S_New },
 
-        { "do", S_Do },
-        { "while", S_While },
-        { "for", S_For },
-        { "break", S_Break },
-        { "continue", S_Continue }
-};
+            { "do", &S_Do },
+            { "while", &S_While },
+            { "for", &S_For },
+            { "break", &S_Break },
+            { "continue", &S_Continue }
+    };
+
+    Ciallang::Collections::FlatHashMap<Ciallang::TjsInternedString, const Token*> result{};
+    for(const auto& [name, token] : keywords) {
+        result.tryEmplace(TjsStringTable::intern(name), token);
+    }
+    return result;
+}();
 
 Lexer::Lexer(SourceFile& sourceFile) : _sourceFile(sourceFile) {
 }
@@ -470,7 +478,8 @@ bool Lexer::numberConstVal(Token*& token) {
 
         const auto runeType = utf8Encode(ch);
         stream << runeType.data;
-        hasDigits = true;
+        // 单独的 '.' 是成员访问, 不是数字
+        hasDigits = hasDigits || isdigit(ch);
         ch = read(false);
     }
 
@@ -698,19 +707,20 @@ void Lexer::extractNumber(int8_t (*validDigits)(char),
 }
 
 bool Lexer::identifier(Token*& token) {
-    const auto name = readIdentifier();
+    const auto string = readIdentifier();
 
-    if(name.empty())
+    if(string.empty())
         return false;
 
+    const auto name = TjsStringTable::intern(string);
+
     // get keyword
-    auto it = S_Keywords.find(name);
-    if(it != S_Keywords.end()) {
-        token = makeToken(it->second);
+    if(const auto* keyword = S_Keywords.find(name)) {
+        token = makeToken(**keyword);
         return true;
     }
 
-    token = makeToken(TokenType::Identifier, TjsValue{ std::move(name) });
+    token = makeToken(Token{ TokenType::Identifier, name });
     return true;
 }
 
@@ -1217,37 +1227,39 @@ bool Lexer::octetLiteral(Token*& token) {
     // <% xx xx xx xx xx xx ... %>
     // where xx is hexadecimal 8bit(octet) binary representation.
     if(match("<%")) {
+        // 两个十六进制数字组成一个字节, 单个数字后跟 ',' 也组成一个字节, 其他字符忽略.
+        // 这里不能调用 skipComment, 它会重新进入 next 解析出完整的 token
         auto newSec = true;
         uint8_t oct = 0;
 
         for(;;) {
-            skipComment();
             auto ch = read(false);
+            if(ch == runeEof || ch == runeInvalid) {
+                return false;
+            }
+
             if(ch == '%') {
                 ch = read(false);
                 if(ch == '>') {
+                    if(!newSec) buf.push_back(oct);
                     token = makeToken(TokenType::ConstVal, TjsOctet::tjsOctet(buf));
                     return true;
                 }
-                _sourceFile.restoreTopMark();
                 return false;
             }
 
-            ch = static_cast<uint8_t>(getHexNum(static_cast<char>(ch)));
-            if(ch != -1) {
+            if(const auto hex = ch < 0x80 ? getHexNum(static_cast<char>(ch)) : -1; hex != -1) {
                 if(newSec) {
-                    oct = ch;
-                    newSec = ch == ',';
-
-                    if(newSec)
-                        buf.push_back(oct);
+                    oct = static_cast<uint8_t>(hex);
+                    newSec = false;
                 } else {
-                    oct <<= 4;
-                    oct += ch;
-
+                    oct = static_cast<uint8_t>(oct << 4 | hex);
                     buf.push_back(oct);
                     newSec = true;
                 }
+            } else if(ch == ',' && !newSec) {
+                buf.push_back(oct);
+                newSec = true;
             }
         }
     }
@@ -19,6 +19,8 @@
 #include "common/SourceFile.hpp"
 #include "common/Result.hpp"
 #include "Token.hpp"
+#include "collections/FlatHashMap.hpp"
+#include "types/TjsStringTable.hpp"
 
 namespace Ciallang::Syntax {
     using namespace std;
@@ -104,7 +106,8 @@ namespace Ciallang::Syntax {
 
         [[maybe_unused]] static void* S_LoadCases;
 
-        static std::unordered_map<std::string, const Token&> S_Keywords;
+        // 键是驻留后的关键字, 标识符驻留之后查表只需要比较指针
+        static Collections::FlatHashMap<TjsInternedString, const Token*> S_Keywords;
 
         std::vector<Token*> _tokens{};
         bool _hasNext = true;
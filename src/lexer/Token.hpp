@@ -18,6 +18,7 @@
 
 #include "IEEETypes.hpp"
 #include "common/SourceLocation.hpp"
+#include "types/TjsStringTable.hpp"
 #include "types/TjsValue.hpp"
 
 namespace Ciallang::Syntax {
@@ -408,9 +409,15 @@ namespace Ciallang::Syntax {
             _type(type), _value(new TjsValue{ std::move(value) }) {
         }
 
+        // 标识符同时保存驻留后的名字, 代码生成只比较句柄
+        explicit Token(const TokenType type, const TjsInternedString identifier) :
+            _type(type), _value(new TjsValue{ identifier.str() }), _identifier(identifier) {
+        }
+
         Token(Token&& token) noexcept {
             _type = token._type;
             _value = token._value;
+            _identifier = token._identifier;
             location = token.location;
 
             token._value = nullptr;
@@ -422,6 +429,7 @@ namespace Ciallang::Syntax {
             if(token._value)
                 _value = new TjsValue{ *token._value };
 
+            _identifier = token._identifier;
             location = token.location;
         }
 
@@ -431,6 +439,7 @@ namespace Ciallang::Syntax {
 
             delete _value;
             _value = token._value;
+            _identifier = token._identifier;
             location = token.location;
 
             token._value = nullptr;
@@ -442,16 +451,21 @@ namespace Ciallang::Syntax {
                 _type = token._type;
 
                 delete _value;
+                _value = nullptr;
                 if(token._value)
                     _value = new TjsValue{ *token._value };
 
+                _identifier = token._identifier;
                 location = token.location;
             }
             return *this;
         }
 
         bool operator==(const Token& token) const {
-            return _type == token.type() && *_value == *token.value();
+            // 运算符之类的 token 没有值
+            if(_type != token.type()) return false;
+            if(!_value || !token.value()) return _value == token.value();
+            return *_value == *token.value();
         }
 
         [[nodiscard]] constexpr TokenType type() const noexcept { return _type; }
@@ -460,6 +474,11 @@ namespace Ciallang::Syntax {
             return _value;
         }
 
+        // 只有标识符有值, 其他 token 返回空句柄
+        [[nodiscard]] constexpr TjsInternedString identifier() const noexcept {
+            return _identifier;
+        }
+
         [[nodiscard]] constexpr const char* name() const noexcept {
             const auto it = S_TypeToName.find(_type);
             if(it != S_TypeToName.end()) {
@@ -473,6 +492,7 @@ namespace Ciallang::Syntax {
     private:
         TokenType _type{ TokenType::Void };
         TjsValue* _value{ nullptr };
+        TjsInternedString _identifier{};
     };
 
     /**
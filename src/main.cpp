@@ -21,7 +21,10 @@
 #include "parser/Parser.hpp"
 #include "parser/Parser.hpp"
 #include "vm/Interpreter.hpp"
+#include "core/math.hpp"
+#include "core/octet.hpp"
 #include "core/print.hpp"
+#include "core/string.hpp"
 
 void testLexer() {
     Ciallang::Common::SourceFile source_file{ R"(.\startup.tjs)" };
@@ -77,7 +80,27 @@ int main(int argc, char** argv) {
     auto chunk = codeGen.parseAst(r, globalNode);
 
     Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("print", Ciallang::TjsValue{ Ciallang::Core::S_PrintFunction });
     interpreter.global("println", Ciallang::TjsValue{ Ciallang::Core::S_PrintlnFunction});
+    interpreter.global("mathAbs", Ciallang::TjsValue{ Ciallang::Core::S_MathAbsFunction });
+    interpreter.global("mathMin", Ciallang::TjsValue{ Ciallang::Core::S_MathMinFunction });
+    interpreter.global("mathMax", Ciallang::TjsValue{ Ciallang::Core::S_MathMaxFunction });
+    interpreter.global("StringBuilder", Ciallang::TjsValue{ Ciallang::Core::S_StringBuilderFunction });
+    interpreter.global("sbAppend", Ciallang::TjsValue{ Ciallang::Core::S_StringBuilderAppendFunction });
+    interpreter.global("sbToString", Ciallang::TjsValue{ Ciallang::Core::S_StringBuilderToStringFunction });
+    interpreter.global("strLength", Ciallang::TjsValue{ Ciallang::Core::S_StringLengthFunction });
+    interpreter.global("strIndexOf", Ciallang::TjsValue{ Ciallang::Core::S_StringIndexOfFunction });
+    interpreter.global("strSubstring", Ciallang::TjsValue{ Ciallang::Core::S_StringSubstringFunction });
+    interpreter.global("strSplit", Ciallang::TjsValue{ Ciallang::Core::S_StringSplitFunction });
+    interpreter.global("strReplace", Ciallang::TjsValue{ Ciallang::Core::S_StringReplaceFunction });
+    interpreter.global("strTrim", Ciallang::TjsValue{ Ciallang::Core::S_StringTrimFunction });
+    interpreter.global("strToUpper", Ciallang::TjsValue{ Ciallang::Core::S_StringToUpperFunction });
+    interpreter.global("strToLower", Ciallang::TjsValue{ Ciallang::Core::S_StringToLowerFunction });
+    interpreter.global("octetLength", Ciallang::TjsValue{ Ciallang::Core::S_OctetLengthFunction });
+    interpreter.global("octetSlice", Ciallang::TjsValue{ Ciallang::Core::S_OctetSliceFunction });
+    interpreter.global("octetFind", Ciallang::TjsValue{ Ciallang::Core::S_OctetFindFunction });
+    interpreter.global("octetToHex", Ciallang::TjsValue{ Ciallang::Core::S_OctetToHexFunction });
+    interpreter.global("octetToBase64", Ciallang::TjsValue{ Ciallang::Core::S_OctetToBase64Function });
 
     fmt::println("{}", interpreter.dumpInstruction(*chunk));
     auto start = std::chrono::high_resolution_clock::now();
@@ -36,22 +36,19 @@ namespace Ciallang::Syntax {
 
     static bool parseArguments(Result& r, Parser* parser, ProcCallExprNode* node) {
         // a(,) -> a(void, void)
-
-        while(!parser->peek(TokenType::RParenthesis)) {
-            if(parser->peek(TokenType::Comma)) {
-                parser->consume();
+        while(true) {
+            if(parser->peek(TokenType::Comma) || parser->peek(TokenType::RParenthesis)) {
+                // 省略的参数为 void
                 node->arguments.push_back(parser->astBuilder()
                                                 ->makeValueExprNode(Token{}));
-
-                if(parser->peek(TokenType::RParenthesis)) {
-                    node->arguments.push_back(parser->astBuilder()
-                                                    ->makeValueExprNode(Token{}));
-                }
-                continue;
+            } else {
+                auto* expr = parser->parseExpression(r);
+                if(!expr) return false;
+                node->arguments.push_back(expr);
             }
-            auto* expr = parser->parseExpression(r);
-            if(!expr) return false;
-            node->arguments.push_back(expr);
+
+            if(!parser->peek(TokenType::Comma)) break;
+            parser->consume();
         }
 
         return true;
@@ -600,20 +597,22 @@ namespace Ciallang::Syntax {
 
         if(!_withAssignment) return binOpNode;
 
-        const IdentifierExprNode* symbolExprNode = dynamic_cast<IdentifierExprNode*>(lhs);
-
-        if(!symbolExprNode) {
-            parser->error(r,
-                "assignment operator left-hand-side expects identifier",
-                lhs->location);
-            return nullptr;
+        if(!dynamic_cast<IdentifierExprNode*>(lhs)) {
+            if(const auto* binaryExprNode = dynamic_cast<BinaryExprNode*>(lhs);
+                !binaryExprNode
+                || (*binaryExprNode->token != S_Dot && *binaryExprNode->token != S_LBracket)) {
+                parser->error(r,
+                    "assignment operator left-hand-side expects identifier or member",
+                    lhs->location);
+                return nullptr;
+            }
         }
 
         if(contains(S_AssignToNonAssign, token->type())) {
-            return parser->astBuilder()->makeAssignExprNode(symbolExprNode, binOpNode);
+            return parser->astBuilder()->makeAssignExprNode(lhs, binOpNode);
         }
 
-        return parser->astBuilder()->makeAssignExprNode(symbolExprNode, rhs);
+        return parser->astBuilder()->makeAssignExprNode(lhs, rhs);
     }
 
     ExprNode* ProcCallInfixParser::parse(Result& r, Parser* parser,
@@ -642,6 +641,21 @@ namespace Ciallang::Syntax {
     }
 
 
+    ExprNode* IndexInfixParser::parse(Result& r, Parser* parser,
+                                      ExprNode* lhs, Token* token) const {
+        const auto index = parser->parseExpression(r);
+        if(!index) {
+            parser->error(r,
+                "index operator expects index expression",
+                token->location);
+            return nullptr;
+        }
+
+        if(!parser->expect(r, &S_RBracket)) return nullptr;
+
+        return parser->astBuilder()->makeBinaryExprNode(std::move(*token), lhs, index);
+    }
+
     ExprNode* ConstValPrefixParser::parse(Result&, Parser* parser, Token* token) const {
         return parser->astBuilder()->makeValueExprNode(std::move(*token));
     }
@@ -333,6 +333,18 @@ namespace Ciallang::Syntax {
         }
     };
 
+    // obj[index], 解析为 token 为 [ 的 BinaryExprNode
+    struct IndexInfixParser final : InfixParser {
+        explicit IndexInfixParser() = default;
+
+        ExprNode* parse(Result& r, Parser* parser,
+                        ExprNode* lhs, Token* token) const override;
+
+        [[nodiscard]] Precedence precedence() const override {
+            return Precedence::postfix;
+        }
+    };
+
     static constinit BinaryOperatorInfixParser
             S_SumSubBinOpInfixParser{ Precedence::sum_sub, false },
             S_ProductBinOpParser{ Precedence::product, false },
@@ -349,6 +361,8 @@ namespace Ciallang::Syntax {
 
     static constinit ProcCallInfixParser S_ProcCallInfixParser{};
 
+    static constinit IndexInfixParser S_IndexInfixParser{};
+
     static constinit auto S_InfixParsers =
             frozen::make_unordered_map<TokenType, const InfixParser*>({
                     { TokenType::Swap, &S_AssignBinOpParser },                    // <->
@@ -392,6 +406,7 @@ namespace Ciallang::Syntax {
                     { TokenType::LogicalOr, &S_LogicalOrBinOpParser },            // ||
                     //            {TokenType::Question,         &S_ConditionalTernaryBinOpParser}, // cond ? expr : expr
                     { TokenType::Dot, &S_MemberAccessBinOpParser },
+                    { TokenType::LBracket, &S_IndexInfixParser },
                     { TokenType::LParenthesis, &S_ProcCallInfixParser }
             });
 }
@@ -33,12 +33,18 @@
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <ranges>
 #include <optional>
 #include <any>
 
 #include <functional>
 #include <compare>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <glog/logging.h>
 
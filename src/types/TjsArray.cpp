@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024/11/1 下午7:48
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "TjsArray.hpp"
+
+namespace Ciallang {
+    size_t TjsArray::size() const noexcept {
+        switch(_kind) {
+            case TjsElementKind::PackedInteger: return _integers.size();
+            case TjsElementKind::PackedReal: return _reals.size();
+            case TjsElementKind::Generic: return _values.size();
+            default: return 0;
+        }
+    }
+
+    TjsValue TjsArray::get(const TjsInteger index) const {
+        const auto position = normalize(index);
+        if(!position.has_value() || position.value() >= size()) return TjsValue{};
+
+        switch(_kind) {
+            case TjsElementKind::PackedInteger: return TjsValue{ _integers[position.value()] };
+            case TjsElementKind::PackedReal: return TjsValue{ _reals[position.value()] };
+            default: return TjsValue{ _values[position.value()] };
+        }
+    }
+
+    void TjsArray::set(const TjsInteger index, TjsValue&& value) {
+        const auto position = normalize(index);
+        if(!position.has_value() || position.value() > size() + MAX_WRITE_GAP) {
+            throw std::out_of_range(fmt::format("array index out of range: {}", index));
+        }
+
+        transitionFor(value, position.value());
+
+        switch(_kind) {
+            case TjsElementKind::PackedInteger:
+                if(position.value() == _integers.size()) {
+                    _integers.push_back(value.asInteger());
+                } else {
+                    _integers[position.value()] = value.asInteger();
+                }
+                break;
+            case TjsElementKind::PackedReal:
+                if(position.value() == _reals.size()) {
+                    _reals.push_back(value.asReal());
+                } else {
+                    _reals[position.value()] = value.asReal();
+                }
+                break;
+            default:
+                if(position.value() >= _values.size()) {
+                    _values.resize(position.value() + 1);
+                }
+                _values[position.value()] = std::move(value);
+        }
+    }
+
+    void TjsArray::push(TjsValue&& value) {
+        set(static_cast<TjsInteger>(size()), std::move(value));
+    }
+
+    std::optional<size_t> TjsArray::normalize(const TjsInteger index) const noexcept {
+        if(index >= 0) return static_cast<size_t>(index);
+
+        const auto position = static_cast<TjsInteger>(size()) + index;
+        if(position < 0) return {};
+        return static_cast<size_t>(position);
+    }
+
+    void TjsArray::transitionFor(const TjsValue& value, const size_t index) {
+        if(_kind == TjsElementKind::Generic) return;
+
+        // 越界写入会留下 void 的空洞
+        if(index > size()) {
+            toGeneric();
+            return;
+        }
+
+        const auto kind = value.isInteger()
+                              ? TjsElementKind::PackedInteger
+                              : value.isReal()
+                                    ? TjsElementKind::PackedReal
+                                    : TjsElementKind::Generic;
+
+        if(_kind == TjsElementKind::Empty && kind != TjsElementKind::Generic) {
+            _kind = kind;
+            return;
+        }
+
+        if(_kind != kind) toGeneric();
+    }
+
+    void TjsArray::toGeneric() {
+        _values.reserve(size());
+        for(const auto integer : _integers) {
+            _values.emplace_back(integer);
+        }
+        for(const auto real : _reals) {
+            _values.emplace_back(real);
+        }
+
+        _integers = {};
+        _reals = {};
+        _kind = TjsElementKind::Generic;
+    }
+}
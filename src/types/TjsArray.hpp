@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024/11/1 下午7:48
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "TjsObject.hpp"
+#include "TjsValue.hpp"
+
+namespace Ciallang {
+    /**
+     * 数组元素的种类, 只会从左往右迁移:
+     *
+     *     Empty -> PackedInteger -> Generic
+     *           -> PackedReal    ->
+     *
+     * TJS 的整数和实数是不同的类型, 整数放进实数数组后读出来必须还是整数,
+     * 所以两种紧凑数组之间不能互相迁移, 混合时直接变为 Generic
+     */
+    enum class TjsElementKind : uint8_t {
+        Empty,
+        PackedInteger,
+        PackedReal,
+        Generic
+    };
+
+    /**
+     * 元素连续存放的数组, 全是整数或全是实数时不需要装箱成 TjsValue
+     *
+     * 下标为负数时从末尾数起; 读取越界返回 void,
+     * 写入越界时中间的元素补 void (数组因此变为 Generic).
+     * 写入位置最多超出末尾 MAX_WRITE_GAP 个元素, 更远的写入抛出 out_of_range,
+     * 避免一个很大的下标申请大量内存
+     */
+    class TjsArray final : public TjsObject {
+    public:
+        static constexpr size_t MAX_WRITE_GAP = 1024 * 1024;
+
+        TjsArray() = default;
+
+        [[nodiscard]] std::string_view name() const noexcept override {
+            return "Array";
+        }
+
+        [[nodiscard]] bool isNative() const noexcept override {
+            return true;
+        }
+
+        [[nodiscard]] size_t arity() const noexcept override {
+            return 0;
+        }
+
+        [[nodiscard]] TjsElementKind kind() const noexcept { return _kind; }
+
+        [[nodiscard]] size_t size() const noexcept;
+
+        [[nodiscard]] TjsValue get(TjsInteger index) const;
+
+        void set(TjsInteger index, TjsValue&& value);
+
+        void push(TjsValue&& value);
+
+        // 紧凑数组的原始存储, 种类不符时为空
+        [[nodiscard]] std::span<const TjsInteger> integers() const noexcept { return _integers; }
+
+        [[nodiscard]] std::span<const TjsReal> reals() const noexcept { return _reals; }
+
+        ~TjsArray() noexcept override = default;
+
+    private:
+        TjsElementKind _kind{ TjsElementKind::Empty };
+
+        // 只有和 _kind 对应的一个容器有元素
+        std::vector<TjsInteger> _integers{};
+        std::vector<TjsReal> _reals{};
+        std::vector<TjsValue> _values{};
+
+        // 负数下标从末尾数起, 仍然越界时返回空
+        [[nodiscard]] std::optional<size_t> normalize(TjsInteger index) const noexcept;
+
+        // 按要存入的值迁移元素种类
+        void transitionFor(const TjsValue& value, size_t index);
+
+        void toGeneric();
+    };
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024/11/3 下午5:12
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "TjsObject.hpp"
+#include "TjsStringTable.hpp"
+#include "TjsValue.hpp"
+#include "collections/FlatHashMap.hpp"
+
+namespace Ciallang {
+    // 以驻留字符串为键的属性表, 比较键只需要比较指针
+    using TjsPropertyMap = Collections::FlatHashMap<TjsInternedString, TjsValue>;
+
+    /**
+     * 字典对象, 键在写入时驻留, 读写不经过形状
+     */
+    class TjsDictionary final : public TjsObject {
+    public:
+        TjsDictionary() = default;
+
+        [[nodiscard]] std::string_view name() const noexcept override {
+            return "Dictionary";
+        }
+
+        [[nodiscard]] bool isNative() const noexcept override {
+            return true;
+        }
+
+        [[nodiscard]] size_t arity() const noexcept override {
+            return 0;
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return _properties.size(); }
+
+        // 没有这个键时返回 nullptr
+        [[nodiscard]] const TjsValue* get(const TjsInternedString key) const {
+            return _properties.find(key);
+        }
+
+        // 没有驻留过的名字不可能是已有的键
+        [[nodiscard]] const TjsValue* get(const std::string_view key) const {
+            const auto interned = TjsStringTable::find(key);
+            return interned ? get(interned) : nullptr;
+        }
+
+        void set(const TjsInternedString key, TjsValue&& value) {
+            _properties.insertOrAssign(key, std::move(value));
+        }
+
+        void set(const std::string_view key, TjsValue&& value) {
+            set(TjsStringTable::intern(key), std::move(value));
+        }
+
+        bool remove(const TjsInternedString key) {
+            return _properties.erase(key);
+        }
+
+        [[nodiscard]] const TjsPropertyMap& properties() const noexcept { return _properties; }
+
+        ~TjsDictionary() noexcept override = default;
+
+    private:
+        TjsPropertyMap _properties{};
+    };
+}
@@ -15,46 +15,51 @@
 
 #include "pch.h"
 
+#include <span>
+
 #include "TjsValue.hpp"
 #include "TjsObject.hpp"
 
+namespace Ciallang::Bytecode {
+    class Interpreter;
+}
+
 namespace Ciallang {
     class TjsNativeFunction final : public TjsObject {
-        using Callback = std::function<TjsValue(const TjsValue*)>;
-        using CallbackVoid = std::function<void(const TjsValue*)>;
-
     public:
-        TjsNativeFunction() = delete;
+        /**
+         * 原生函数调用约定
+         * arguments 直接引用调用方连续的参数寄存器, 个数不少于 arity
+         * ret 指向目标寄存器, 调用前已置为 void, 不写入即返回 void
+         * context 为注册时绑定的上下文, 没有时为 nullptr
+         */
+        using Callback = void (*)(
+            Bytecode::Interpreter& interpreter,
+            std::span<const TjsValue> arguments,
+            TjsValue* ret,
+            void* context
+        );
 
-        explicit TjsNativeFunction(
-            const Callback& callback,
-            const size_t arity,
-            std::string&& name
-        ): _callback(callback), _arity(arity), _name(std::move(name)) {
-        }
+        TjsNativeFunction() = delete;
 
         explicit TjsNativeFunction(
-            const Callback& callback,
+            const Callback callback,
             const size_t arity,
-            const std::string& name
-        ): _callback(callback), _arity(arity), _name(name) {
+            std::string name,
+            void* context = nullptr
+        ): _callback(callback), _context(context), _arity(arity), _name(std::move(name)) {
+            DCHECK(_callback);
         }
 
-        explicit TjsNativeFunction(
-            const CallbackVoid& callback,
-            const size_t arity,
-            const std::string& name
-        ): _callback([=](const auto* values) {
-               // just warp
-               callback(values);
-               return TjsValue{};
-           }),
-           _arity(arity), _name(name) {
+        void call(
+            Bytecode::Interpreter& interpreter,
+            const std::span<const TjsValue> arguments,
+            TjsValue* ret
+        ) const {
+            _callback(interpreter, arguments, ret, _context);
         }
 
-        TjsValue callProc(const TjsValue* values) const {
-            return _callback(values);
-        }
+        [[nodiscard]] Callback callback() const noexcept { return _callback; }
 
         [[nodiscard]] std::string_view name() const noexcept override {
             return _name;
@@ -72,6 +77,7 @@ namespace Ciallang {
 
     private:
         const Callback _callback;
+        void* const _context;
         const size_t _arity;
         const std::string _name;
     };
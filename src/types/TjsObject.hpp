@@ -15,17 +15,24 @@
 #include "pch.h"
 
 namespace Ciallang {
+    class TjsShape;
 
     class TjsObject {
     public:
 
         virtual ~TjsObject() noexcept = default;
 
+        // 只有脚本对象有形状, 属性指令据此判断能否按槽位访问
+        [[nodiscard]] TjsShape* shape() const noexcept { return _shape; }
+
         [[nodiscard]] virtual std::string_view name() const noexcept = 0;
 
         [[nodiscard]] virtual bool isNative() const noexcept = 0;
 
         [[nodiscard]] virtual size_t arity() const noexcept = 0;
+
+    protected:
+        TjsShape* _shape{ nullptr };
     };
 
 }
@@ -12,10 +12,199 @@
 
 #include "TjsOctet.hpp"
 
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CIALLANG_OCTET_SSE2 1
+#endif
+
 #include "TjsValue.hpp"
 
 namespace Ciallang {
+    TjsOctet* TjsOctet::make(std::vector<uint8_t>&& bytes) {
+        return new TjsOctet{ std::move(bytes) };
+    }
+
+    TjsOctet* TjsOctet::slice(TjsOctet* source, const size_t offset, const size_t length) {
+        if(offset > source->_size) {
+            throw std::out_of_range(fmt::format(
+                "octet slice offset {} out of range, size is {}", offset, source->_size
+            ));
+        }
+
+        auto* owner = source->_owner ? source->_owner : source;
+        return new TjsOctet{
+            owner->retain(),
+            source->_data + offset,
+            std::min(length, source->_size - offset)
+        };
+    }
+
+    TjsOctet* TjsOctet::concat(const TjsOctet* left, const TjsOctet* right) {
+        std::vector<uint8_t> bytes(left->_size + right->_size);
+        if(left->_size) std::memcpy(bytes.data(), left->_data, left->_size);
+        if(right->_size) std::memcpy(bytes.data() + left->_size, right->_data, right->_size);
+        return make(std::move(bytes));
+    }
+
+    void TjsOctet::release(TjsOctet* octet) noexcept {
+        if(--octet->_refs) return;
+
+        // 切片只有一层 owner, 不会递归
+        auto* owner = octet->_owner;
+        delete octet;
+        if(owner && --owner->_refs == 0) delete owner;
+    }
+
+    std::strong_ordering TjsOctet::compare(const TjsOctet& other) const noexcept {
+        const auto length = std::min(_size, other._size);
+        if(length) {
+            if(const int result = std::memcmp(_data, other._data, length)) {
+                return result < 0 ? std::strong_ordering::less : std::strong_ordering::greater;
+            }
+        }
+        return _size <=> other._size;
+    }
+
+    size_t TjsOctet::find(const std::span<const uint8_t> needle, const size_t from) const noexcept {
+        if(from > _size || needle.size() > _size - from) return npos;
+        if(needle.empty()) return from;
+
+        const auto* haystack = _data + from;
+        const size_t last = _size - from - needle.size();
+        size_t i = 0;
+
+#ifdef CIALLANG_OCTET_SSE2
+        // 一次比较 16 个起点的首字节和尾字节, 两者都相同的起点再逐字节确认
+        const __m128i first = _mm_set1_epi8(static_cast<char>(needle.front()));
+        const __m128i tail = _mm_set1_epi8(static_cast<char>(needle.back()));
+        for(; i + 16 <= last + 1; i += 16) {
+            const __m128i blockFirst = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(haystack + i)
+            );
+            const __m128i blockTail = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(haystack + i + needle.size() - 1)
+            );
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(first, blockFirst),
+                _mm_cmpeq_epi8(tail, blockTail)
+            )));
+            while(mask) {
+                const auto index = i + std::countr_zero(mask);
+                if(std::memcmp(haystack + index, needle.data(), needle.size()) == 0) {
+                    return from + index;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+
+        for(; i <= last; ++i) {
+            if(haystack[i] == needle.front()
+               && std::memcmp(haystack + i, needle.data(), needle.size()) == 0) {
+                return from + i;
+            }
+        }
+        return npos;
+    }
+
+    std::string TjsOctet::toHex() const {
+        static constexpr char digits[] = "0123456789abcdef";
+
+        std::string result(_size * 2, '\0');
+        auto* out = result.data();
+        size_t i = 0;
+
+#ifdef CIALLANG_OCTET_SSE2
+        // 拆出高低半字节, 0-9 加 '0', a-f 再多加 'a' - '0' - 10, 最后交错写出
+        const __m128i lowMask = _mm_set1_epi8(0x0f);
+        const __m128i nine = _mm_set1_epi8(9);
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+        const auto toDigits = [&](const __m128i nibbles) {
+            return _mm_add_epi8(
+                _mm_add_epi8(nibbles, zero),
+                _mm_and_si128(_mm_cmpgt_epi8(nibbles, nine), letter)
+            );
+        };
+
+        for(; i + 16 <= _size; i += 16) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_data + i));
+            const __m128i high = toDigits(_mm_and_si128(_mm_srli_epi16(block, 4), lowMask));
+            const __m128i low = toDigits(_mm_and_si128(block, lowMask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(high, low));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+        }
+#endif
+
+        for(; i < _size; ++i) {
+            out[i * 2] = digits[_data[i] >> 4];
+            out[i * 2 + 1] = digits[_data[i] & 0x0f];
+        }
+        return result;
+    }
+
+    std::string TjsOctet::toBase64() const {
+        static constexpr char alphabet[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string result((_size + 2) / 3 * 4, '=');
+        auto* out = result.data();
+        size_t i = 0;
+
+#ifdef CIALLANG_OCTET_SSE2
+        // SSE2 没有字节重排, 每 12 字节先标量拼成 4 个 24 位的 32 位槽,
+        // 再用移位掩码拆出 16 个 6 位下标, 按区间比较累加偏移映射到字母表
+        const __m128i sixBits = _mm_set1_epi32(0x3f);
+        const __m128i upper = _mm_set1_epi8('A');
+        const auto above = [](const __m128i index, const char bound, const char delta) {
+            return _mm_and_si128(_mm_cmpgt_epi8(index, _mm_set1_epi8(bound)), _mm_set1_epi8(delta));
+        };
+
+        for(; i + 12 <= _size; i += 12, out += 16) {
+            const auto lane = [&](const size_t at) {
+                return static_cast<int>(_data[at] << 16 | _data[at + 1] << 8 | _data[at + 2]);
+            };
+            const __m128i bits = _mm_set_epi32(lane(i + 9), lane(i + 6), lane(i + 3), lane(i));
+            const __m128i index = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_and_si128(_mm_srli_epi32(bits, 18), sixBits),
+                    _mm_and_si128(_mm_srli_epi32(bits, 4), _mm_slli_epi32(sixBits, 8))
+                ),
+                _mm_or_si128(
+                    _mm_and_si128(_mm_slli_epi32(bits, 10), _mm_slli_epi32(sixBits, 16)),
+                    _mm_and_si128(_mm_slli_epi32(bits, 24), _mm_slli_epi32(sixBits, 24))
+                )
+            );
+            // 0-25 -> 'A', 26-51 -> 'a', 52-61 -> '0', 62 -> '+', 63 -> '/'
+            __m128i offset = _mm_add_epi8(upper, above(index, 25, 'a' - 26 - 'A'));
+            offset = _mm_add_epi8(offset, above(index, 51, '0' - 52 - ('a' - 26)));
+            offset = _mm_add_epi8(offset, above(index, 61, '+' - 62 - ('0' - 52)));
+            offset = _mm_add_epi8(offset, above(index, 62, '/' - 63 - ('+' - 62)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi8(index, offset));
+        }
+#endif
+
+        // 每 3 个字节拼成 24 位, 拆成 4 个 6 位下标
+        for(; i + 3 <= _size; i += 3, out += 4) {
+            const uint32_t bits = _data[i] << 16 | _data[i + 1] << 8 | _data[i + 2];
+            out[0] = alphabet[bits >> 18];
+            out[1] = alphabet[bits >> 12 & 0x3f];
+            out[2] = alphabet[bits >> 6 & 0x3f];
+            out[3] = alphabet[bits & 0x3f];
+        }
+
+        if(const auto rest = _size - i) {
+            const uint32_t bits = _data[i] << 16 | (rest == 2 ? _data[i + 1] << 8 : 0);
+            out[0] = alphabet[bits >> 18];
+            out[1] = alphabet[bits >> 12 & 0x3f];
+            if(rest == 2) out[2] = alphabet[bits >> 6 & 0x3f];
+        }
+        return result;
+    }
+
     TjsValue TjsOctet::tjsOctet(const std::vector<uint8_t>& value) {
-        return TjsValue{ TjsOctet{ value } };
+        return TjsValue{ make(std::vector{ value }) };
     }
 }
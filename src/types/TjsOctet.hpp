@@ -12,19 +12,81 @@
 
 #pragma once
 
+#include <span>
+
 #include "TjsTypes.hpp"
 #include "TjsValue.hpp"
 
 namespace Ciallang {
+    /**
+     * 不可变的引用计数二进制数据, TjsValue 中的 octet 都以它保存
+     *
+     * 切片和原数据共享同一块缓冲区, 只记录起始位置和长度, 不拷贝内容.
+     * 切片持有缓冲区所在 octet 的引用, 切片的切片仍然直接指向它
+     *
+     * 只在解释器线程中使用, 引用计数不是原子的
+     */
     class TjsOctet {
-        std::vector<uint8_t> _buf;
-
     public:
-        explicit TjsOctet(std::vector<uint8_t> buf) : _buf(std::move(buf)) {
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        TjsOctet(const TjsOctet&) = delete;
+        TjsOctet& operator=(const TjsOctet&) = delete;
+
+        // 引用计数为 1
+        static TjsOctet* make(std::vector<uint8_t>&& bytes);
+
+        // [offset, offset + length) 的切片, length 超出末尾时截断, offset 超出末尾时抛出 std::out_of_range
+        static TjsOctet* slice(TjsOctet* source, size_t offset, size_t length = npos);
+
+        // 拼接需要拷贝到新的缓冲区
+        static TjsOctet* concat(const TjsOctet* left, const TjsOctet* right);
+
+        TjsOctet* retain() noexcept {
+            ++_refs;
+            return this;
         }
 
+        static void release(TjsOctet* octet) noexcept;
+
+        [[nodiscard]] size_t size() const noexcept { return _size; }
+
+        [[nodiscard]] const uint8_t* data() const noexcept { return _data; }
+
+        [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return { _data, _size }; }
+
+        // 按字节的字典序比较
+        [[nodiscard]] std::strong_ordering compare(const TjsOctet& other) const noexcept;
+
+        // 从 from 开始查找 needle 第一次出现的位置, 找不到时返回 npos
+        [[nodiscard]] size_t find(std::span<const uint8_t> needle, size_t from = 0) const noexcept;
+
+        // 小写十六进制, 每个字节两个字符
+        [[nodiscard]] std::string toHex() const;
+
+        // 标准 base64 (RFC 4648), 带 '=' 填充
+        [[nodiscard]] std::string toBase64() const;
+
         static TjsValue tjsOctet(const std::vector<uint8_t>&);
-    };
 
+    private:
+        explicit TjsOctet(std::vector<uint8_t>&& bytes) :
+            _bytes(std::move(bytes)), _data(_bytes.data()), _size(_bytes.size()) {
+        }
 
+        explicit TjsOctet(TjsOctet* owner, const uint8_t* data, const size_t size) :
+            _owner(owner), _data(data), _size(size) {
+        }
+
+        ~TjsOctet() noexcept = default;
+
+        size_t _refs{ 1 };
+
+        // 切片引用的缓冲区所在的 octet, 自身持有缓冲区时为 nullptr
+        TjsOctet* _owner{ nullptr };
+        const std::vector<uint8_t> _bytes{};
+
+        const uint8_t* const _data;
+        const size_t _size;
+    };
 }
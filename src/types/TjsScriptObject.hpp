@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024/10/27 下午4:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "TjsDictionary.hpp"
+#include "TjsObject.hpp"
+#include "TjsShape.hpp"
+#include "TjsStringTable.hpp"
+#include "TjsValue.hpp"
+
+namespace Ciallang {
+    /**
+     * 脚本对象, 属性值按形状给出的下标保存在槽位数组中
+     *
+     * 属性数量超过 MAX_FAST_PROPERTIES 后转为字典模式,
+     * 属性改存在以驻留字符串为键的哈希表中, 形状固定为 TjsShape::dictionary()
+     */
+    class TjsScriptObject final : public TjsObject {
+    public:
+        // 形状链上按名字查找是线性的, 属性太多时不如哈希表
+        static constexpr uint32_t MAX_FAST_PROPERTIES = 64;
+
+        TjsScriptObject() {
+            _shape = TjsShape::root();
+        }
+
+        [[nodiscard]] std::string_view name() const noexcept override {
+            return "object";
+        }
+
+        [[nodiscard]] bool isNative() const noexcept override {
+            return false;
+        }
+
+        [[nodiscard]] size_t arity() const noexcept override {
+            return 0;
+        }
+
+        [[nodiscard]] std::optional<uint32_t> find(const TjsInternedString name) const {
+            return _shape->lookup(name);
+        }
+
+        [[nodiscard]] std::optional<uint32_t> find(const std::string_view name) const {
+            const auto interned = TjsStringTable::find(name);
+            if(!interned) return {};
+            return find(interned);
+        }
+
+        [[nodiscard]] const TjsValue& slot(const uint32_t index) const {
+            DCHECK_LT(index, _slots.size());
+            return _slots[index];
+        }
+
+        void slot(const uint32_t index, TjsValue&& value) {
+            DCHECK_LT(index, _slots.size());
+            _slots[index] = std::move(value);
+        }
+
+        // 添加新属性, 属性已经太多时先转为字典模式
+        void define(const TjsInternedString name, TjsValue&& value) {
+            if(!_dictionary && _shape->slotCount() >= MAX_FAST_PROPERTIES) {
+                toDictionary();
+            }
+
+            if(_dictionary) {
+                _dictionary->insertOrAssign(name, std::move(value));
+                return;
+            }
+            transition(_shape->addProperty(name), std::move(value));
+        }
+
+        // 迁移到已知的子形状, 新属性的值放在最后一个槽位
+        void transition(TjsShape* shape, TjsValue&& value) {
+            DCHECK_EQ(shape->parent(), _shape);
+            _shape = shape;
+            _slots.push_back(std::move(value));
+        }
+
+        // 快速模式下为 nullptr
+        [[nodiscard]] TjsPropertyMap* dictionary() noexcept {
+            return _dictionary ? &_dictionary.value() : nullptr;
+        }
+
+        [[nodiscard]] const TjsPropertyMap* dictionary() const noexcept {
+            return _dictionary ? &_dictionary.value() : nullptr;
+        }
+
+        // 按名字读取, 没有这个属性时返回 nullptr
+        [[nodiscard]] const TjsValue* get(const TjsInternedString name) const {
+            if(_dictionary) return _dictionary->find(name);
+
+            const auto index = find(name);
+            return index.has_value() ? &_slots[index.value()] : nullptr;
+        }
+
+        [[nodiscard]] const TjsValue* get(const std::string_view name) const {
+            const auto interned = TjsStringTable::find(name);
+            return interned ? get(interned) : nullptr;
+        }
+
+        // 按名字写入, 没有这个属性时添加
+        void set(const TjsInternedString name, TjsValue&& value) {
+            if(_dictionary) {
+                _dictionary->insertOrAssign(name, std::move(value));
+                return;
+            }
+
+            if(const auto index = find(name)) {
+                slot(index.value(), std::move(value));
+                return;
+            }
+            define(name, std::move(value));
+        }
+
+        void set(const std::string_view name, TjsValue&& value) {
+            set(TjsStringTable::intern(name), std::move(value));
+        }
+
+        ~TjsScriptObject() noexcept override = default;
+
+    private:
+        std::vector<TjsValue> _slots{};
+        std::optional<TjsPropertyMap> _dictionary{};
+
+        void toDictionary() {
+            TjsPropertyMap dictionary{};
+            dictionary.reserve(_slots.size() + 1);
+            for(const auto* shape = _shape; shape->parent(); shape = shape->parent()) {
+                dictionary.tryEmplace(shape->property(), std::move(_slots[shape->slotCount() - 1]));
+            }
+
+            _slots.clear();
+            _shape = TjsShape::dictionary();
+            _dictionary.emplace(std::move(dictionary));
+        }
+    };
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2024/10/27 下午4:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "TjsShape.hpp"
+
+namespace Ciallang {
+    TjsShape* TjsShape::root() {
+        static TjsShape root{ nullptr, {}, 0 };
+        return &root;
+    }
+
+    TjsShape* TjsShape::dictionary() {
+        static TjsShape dictionary{ nullptr, {}, 0 };
+        return &dictionary;
+    }
+
+    TjsShape* TjsShape::addProperty(const TjsInternedString name) {
+        DCHECK(!lookup(name).has_value()) << "property already exists: " << name.str();
+
+        auto& transition = _transitions[name];
+        if(!transition) {
+            transition.reset(new TjsShape{ this, name, _slotCount + 1 });
+        }
+        return transition.get();
+    }
+
+    std::optional<uint32_t> TjsShape::lookup(const TjsInternedString name) const {
+        // 新添加的属性离叶子更近, 从叶子往根找
+        for(const auto* shape = this; shape->_parent; shape = shape->_parent) {
+            if(shape->_property == name) return shape->_slotCount - 1;
+        }
+        return {};
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2024/10/27 下午4:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "TjsStringTable.hpp"
+#include "collections/FlatHashMap.hpp"
+
+namespace Ciallang {
+    /**
+     * 隐藏类 (形状): 记录对象有哪些属性以及每个属性在槽位数组中的下标
+     *
+     * 按相同顺序添加相同属性的对象共享同一个形状, 形状之间组成一棵迁移树,
+     * 根是没有属性的空形状. 属性指令缓存形状和槽位,
+     * 形状相同时直接按下标读写, 不需要按名字查找
+     *
+     * 形状一旦创建就不会释放, 只在解释器线程中使用
+     */
+    class TjsShape {
+    public:
+        TjsShape(const TjsShape&) = delete;
+        TjsShape& operator=(const TjsShape&) = delete;
+
+        // 所有对象最初的形状
+        static TjsShape* root();
+
+        // 字典模式对象共用的形状, 属性不在形状上, 内联缓存不会命中它
+        static TjsShape* dictionary();
+
+        // 添加属性后的形状, 同名的迁移只创建一次
+        TjsShape* addProperty(TjsInternedString name);
+
+        // 属性的槽位下标, 没有这个属性时为空
+        [[nodiscard]] std::optional<uint32_t> lookup(TjsInternedString name) const;
+
+        [[nodiscard]] uint32_t slotCount() const noexcept { return _slotCount; }
+
+        [[nodiscard]] TjsShape* parent() const noexcept { return _parent; }
+
+        // 从父形状迁移过来时添加的属性
+        [[nodiscard]] TjsInternedString property() const noexcept { return _property; }
+
+    private:
+        explicit TjsShape(
+            TjsShape* parent,
+            const TjsInternedString property,
+            const uint32_t slotCount
+        ) : _parent(parent), _property(property), _slotCount(slotCount) {
+        }
+
+        TjsShape* _parent;
+        const TjsInternedString _property;
+        const uint32_t _slotCount;
+
+        Collections::FlatHashMap<TjsInternedString, std::unique_ptr<TjsShape>> _transitions{};
+    };
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024/11/5 下午2:36
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "TjsString.hpp"
+
+namespace Ciallang {
+    TjsString* TjsString::make(std::string&& string) {
+        return new TjsString{ std::move(string) };
+    }
+
+    TjsString* TjsString::concat(TjsString* left, TjsString* right) {
+        if(right->_size == 0) {
+            release(right);
+            return left;
+        }
+        if(left->_size == 0) {
+            release(left);
+            return right;
+        }
+
+        if(left->_size + right->_size < ROPE_MIN_LENGTH) {
+            std::string string{};
+            string.reserve(left->_size + right->_size);
+            left->forEachPiece([&](const std::string_view piece) { string.append(piece); });
+            right->forEachPiece([&](const std::string_view piece) { string.append(piece); });
+            release(left);
+            release(right);
+            return make(std::move(string));
+        }
+
+        return new TjsString{ left, right };
+    }
+
+    TjsString* TjsString::substring(TjsString* source, const size_t offset, const size_t length) {
+        if(offset > source->_size) {
+            throw std::out_of_range(fmt::format(
+                "substring offset {} out of range, size is {}", offset, source->_size
+            ));
+        }
+
+        const auto size = std::min(length, source->_size - offset);
+        if(size == source->_size) return source->retain();
+
+        const auto content = source->view().substr(offset, size);
+        if(size < ROPE_MIN_LENGTH) return make(std::string{ content });
+
+        // 切片的切片直接指向底层的平坦字符串
+        auto* base = source->_base ? source->_base : source;
+        return new TjsString{ base->retain(), offset + (source->_base ? source->_offset : 0), size };
+    }
+
+    void TjsString::release(TjsString* string) noexcept {
+        if(--string->_refs != 0) return;
+        if(string->_base) {
+            if(--string->_base->_refs == 0) delete string->_base;
+            delete string;
+            return;
+        }
+        if(string->flat()) {
+            delete string;
+            return;
+        }
+
+        std::vector<TjsString*> pending{ string };
+        while(!pending.empty()) {
+            auto* node = pending.back();
+            pending.pop_back();
+
+            if(node->_left) {
+                if(--node->_left->_refs == 0) pending.push_back(node->_left);
+                if(--node->_right->_refs == 0) pending.push_back(node->_right);
+            }
+            if(node->_base && --node->_base->_refs == 0) {
+                pending.push_back(node->_base);
+            }
+            delete node;
+        }
+    }
+
+    std::string_view TjsString::view() const {
+        if(flat()) return piece();
+
+        std::string string{};
+        string.reserve(_size);
+        forEachPiece([&](const std::string_view piece) { string.append(piece); });
+
+        _string = std::move(string);
+        release(_left);
+        release(_right);
+        _left = _right = nullptr;
+        _depth = 0;
+        return _string;
+    }
+}
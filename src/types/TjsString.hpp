@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024/11/5 下午2:36
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+namespace Ciallang {
+    /**
+     * 不可变的引用计数字符串, TjsValue 中的字符串都以它保存
+     *
+     * 可以是一段连续的字符 (平坦), 也可以是两段字符串的惰性拼接 (rope).
+     * 拼接只创建一个节点, 第一次需要连续内容时才展开并缓存,
+     * 所以循环中反复用 + 拼接字符串是线性的
+     *
+     * 子串是切片: 持有一个平坦字符串的引用, 只记录起始位置和长度, 不拷贝内容
+     *
+     * 只在解释器线程中使用, 引用计数不是原子的
+     */
+    class TjsString {
+    public:
+        // 结果短于这个长度时直接拷贝成平坦字符串, 不创建 rope 节点或切片
+        static constexpr size_t ROPE_MIN_LENGTH = 32;
+
+        TjsString(const TjsString&) = delete;
+        TjsString& operator=(const TjsString&) = delete;
+
+        // 引用计数为 1
+        static TjsString* make(std::string&& string);
+
+        // 接管 left 和 right 的引用, 返回的字符串引用计数为 1
+        static TjsString* concat(TjsString* left, TjsString* right);
+
+        // 按字节的 [offset, offset + length) 子串, 不接管 source 的引用.
+        // length 超出末尾时截断, offset 超出末尾时抛出 std::out_of_range
+        static TjsString* substring(TjsString* source, size_t offset, size_t length);
+
+        TjsString* retain() noexcept {
+            ++_refs;
+            return this;
+        }
+
+        // 非递归释放, 很深的 rope 也不会栈溢出
+        static void release(TjsString* string) noexcept;
+
+        [[nodiscard]] size_t size() const noexcept { return _size; }
+
+        [[nodiscard]] bool flat() const noexcept { return _left == nullptr; }
+
+        [[nodiscard]] uint32_t depth() const noexcept { return _depth; }
+
+        // 连续的内容, rope 在这里展开, 之后不再保留子节点; 切片直接指向原字符串
+        [[nodiscard]] std::string_view view() const;
+
+        // 按顺序访问每一段连续内容, 不展开 rope
+        template <typename F>
+        void forEachPiece(F&& visit) const {
+            if(flat()) {
+                visit(piece());
+                return;
+            }
+
+            std::vector<const TjsString*> stack{ _right, _left };
+            while(!stack.empty()) {
+                const auto* node = stack.back();
+                stack.pop_back();
+
+                if(node->flat()) {
+                    visit(node->piece());
+                    continue;
+                }
+                stack.push_back(node->_right);
+                stack.push_back(node->_left);
+            }
+        }
+
+    private:
+        explicit TjsString(std::string&& string) :
+            _size(string.size()), _string(std::move(string)) {
+        }
+
+        explicit TjsString(TjsString* left, TjsString* right) :
+            _size(left->_size + right->_size),
+            _depth(std::max(left->_depth, right->_depth) + 1),
+            _left(left), _right(right) {
+        }
+
+        explicit TjsString(TjsString* base, const size_t offset, const size_t size) :
+            _size(size), _base(base), _offset(offset) {
+        }
+
+        ~TjsString() noexcept = default;
+
+        // 平坦字符串或切片的内容
+        [[nodiscard]] std::string_view piece() const noexcept {
+            if(_base) return std::string_view{ _base->_string }.substr(_offset, _size);
+            return _string;
+        }
+
+        size_t _refs{ 1 };
+        const size_t _size;
+
+        // 切片引用的平坦字符串, 不是切片时为 nullptr
+        TjsString* const _base{ nullptr };
+        const size_t _offset{ 0 };
+
+        // 展开后 rope 变为平坦字符串
+        mutable uint32_t _depth{ 0 };
+        mutable TjsString* _left{ nullptr };
+        mutable TjsString* _right{ nullptr };
+        mutable std::string _string{};
+    };
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024/11/5 下午4:10
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "TjsObject.hpp"
+#include "TjsString.hpp"
+#include "TjsValue.hpp"
+
+namespace Ciallang {
+    /**
+     * 可变的字符串缓冲区, 追加时按倍数扩容, 拼接大量片段是线性的
+     */
+    class TjsStringBuilder final : public TjsObject {
+    public:
+        TjsStringBuilder() = default;
+
+        [[nodiscard]] std::string_view name() const noexcept override {
+            return "StringBuilder";
+        }
+
+        [[nodiscard]] bool isNative() const noexcept override {
+            return true;
+        }
+
+        [[nodiscard]] size_t arity() const noexcept override {
+            return 0;
+        }
+
+        // 字符串按片段追加, 不展开 rope; 数字按显示格式追加, void 不追加
+        void append(const TjsValue& value) {
+            switch(value.type()) {
+                case TjsValueType::String:
+                    if(const auto* string = value.asTjsString()) {
+                        string->forEachPiece([this](const std::string_view piece) {
+                            _buffer.append(piece);
+                        });
+                    } else {
+                        _buffer.append(value.asString());
+                    }
+                    break;
+                case TjsValueType::Integer:
+                case TjsValueType::Real:
+                    fmt::format_to(std::back_inserter(_buffer), "{}", value);
+                    break;
+                case TjsValueType::Void:
+                    break;
+                default:
+                    throw std::logic_error("StringBuilder can't append " + value.name());
+            }
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return _buffer.size(); }
+
+        void clear() noexcept { _buffer.clear(); }
+
+        [[nodiscard]] TjsValue toString() const {
+            return TjsValue{ _buffer };
+        }
+
+        ~TjsStringBuilder() noexcept override = default;
+
+    private:
+        std::string _buffer{};
+    };
+}
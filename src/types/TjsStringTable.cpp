@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2024/11/3 下午4:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+
+#include "TjsStringTable.hpp"
+
+namespace Ciallang {
+    TjsStringTable& TjsStringTable::instance() {
+        static TjsStringTable table{};
+        return table;
+    }
+
+    TjsInternedString TjsStringTable::intern(const std::string_view string) {
+        auto& table = instance();
+        std::lock_guard lock{ table._lock };
+
+        if(const auto* interned = table._table.find(string)) {
+            return TjsInternedString{ *interned };
+        }
+
+        const auto& stored = table._strings.emplace_back(string);
+        table._table.tryEmplace(stored, &stored);
+        return TjsInternedString{ &stored };
+    }
+
+    TjsInternedString TjsStringTable::find(const std::string_view string) {
+        auto& table = instance();
+        std::lock_guard lock{ table._lock };
+
+        if(const auto* interned = table._table.find(string)) {
+            return TjsInternedString{ *interned };
+        }
+        return {};
+    }
+
+    size_t TjsStringTable::size() {
+        auto& table = instance();
+        std::lock_guard lock{ table._lock };
+        return table._strings.size();
+    }
+}
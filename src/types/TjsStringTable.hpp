@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024/11/3 下午4:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include <deque>
+
+#include "collections/FlatHashMap.hpp"
+
+namespace Ciallang {
+    /**
+     * 驻留字符串的句柄, 内容相同的字符串只保存一份,
+     * 所以比较两个句柄只需要比较指针
+     */
+    class TjsInternedString {
+    public:
+        TjsInternedString() = default;
+
+        [[nodiscard]] const std::string& str() const noexcept { return *_string; }
+
+        [[nodiscard]] std::string_view view() const noexcept { return *_string; }
+
+        [[nodiscard]] const std::string* get() const noexcept { return _string; }
+
+        explicit operator bool() const noexcept { return _string != nullptr; }
+
+        bool operator==(const TjsInternedString&) const noexcept = default;
+
+    private:
+        friend class TjsStringTable;
+
+        explicit TjsInternedString(const std::string* string) : _string(string) {
+        }
+
+        const std::string* _string{ nullptr };
+    };
+
+    /**
+     * 进程内唯一的字符串驻留表, 驻留的字符串不会释放
+     */
+    class TjsStringTable {
+    public:
+        TjsStringTable(const TjsStringTable&) = delete;
+        TjsStringTable& operator=(const TjsStringTable&) = delete;
+
+        static TjsInternedString intern(std::string_view string);
+
+        // 只查询不驻留, 没有驻留过时返回空句柄. 运行时产生的名字用于读取时走这里, 避免驻留表无限增长
+        static TjsInternedString find(std::string_view string);
+
+        [[nodiscard]] static size_t size();
+
+    private:
+        TjsStringTable() = default;
+
+        static TjsStringTable& instance();
+
+        std::mutex _lock{};
+
+        // deque 追加元素时不会移动已有的字符串, 句柄和视图都保持有效
+        std::deque<std::string> _strings{};
+        Collections::FlatHashMap<std::string_view, const std::string*> _table{};
+    };
+}
+
+template <>
+struct std::hash<Ciallang::TjsInternedString> {
+    size_t operator()(const Ciallang::TjsInternedString& string) const noexcept {
+        // 驻留的 std::string 对象按自身大小排列, 低位没有区分度
+        return reinterpret_cast<uintptr_t>(string.get()) >> 4;
+    }
+};
@@ -14,9 +14,13 @@
 
 #include "TjsOctet.hpp"
 #include "TjsObject.hpp"
+#include "TjsString.hpp"
 
 
 namespace Ciallang {
+    // 短字符串借用 _value 之后的填充字节, 值的大小保持不变
+    static_assert(sizeof(TjsValue) == 16);
+
     TjsValue::TjsValue(const TjsInteger& value) :
         _value{ ._integer = value },
         _type(TjsValueType::Integer) {
@@ -29,16 +33,35 @@ namespace Ciallang {
 
     TjsValue::TjsValue(const std::string& value) :
         _type(TjsValueType::String) {
-        _value._string = new std::string{ value };
+        assignString(value);
+    }
+
+    TjsValue::TjsValue(std::string&& value) :
+        _type(TjsValueType::String) {
+        if(value.size() <= SMALL_STRING_CAPACITY) {
+            assignString(value);
+            return;
+        }
+        _value._string = TjsString::make(std::move(value));
     }
 
-    TjsValue::TjsValue(const TjsOctet& value) :
+    TjsValue::TjsValue(TjsString* string) :
+        _type(TjsValueType::String) {
+        _value._string = string;
+    }
+
+    TjsValue::TjsValue(TjsOctet* octet) :
         _type(TjsValueType::Octet) {
-        _value._octet = new TjsOctet{ value };
+        _value._octet = octet;
     }
 
-    TjsValue::TjsValue(const TjsValue& value) noexcept {
+    TjsValue::TjsValue(const TjsValue& value) noexcept :
+        _smallSize(value._smallSize) {
         _type = value._type;
+        if(isSmallString()) {
+            std::memcpy(smallData(), value.smallData(), _smallSize);
+            return;
+        }
         switch(_type) {
             case TjsValueType::Integer:
                 _value._integer = value._value._integer;
@@ -50,10 +73,12 @@ namespace Ciallang {
                 _value._object = value._value._object;
                 break;
             case TjsValueType::String:
-                _value._string = new std::string(value._value._string->c_str());
+                // 字符串不可变, 拷贝只增加引用计数
+                _value._string = value._value._string->retain();
                 break;
             case TjsValueType::Octet:
-                _value._octet = new TjsOctet(*value._value._octet);
+                // 二进制数据同样不可变, 只增加引用计数
+                _value._octet = value._value._octet->retain();
                 break;
             default: ;
         }
@@ -61,28 +86,62 @@ namespace Ciallang {
 
     TjsValue::TjsValue(TjsValue&& value) noexcept :
         _value(value._value),
+        _smallSize(value._smallSize),
         _type(value._type) {
+        std::memcpy(_small, value._small, sizeof(_small));
         value._value = {};
+        value._type = TjsValueType::Void;
     }
 
     TjsValue& TjsValue::operator=(TjsValue&& value) noexcept {
         if(this == &value) return *this;
 
+        reset();
         _value = value._value;
+        std::memcpy(_small, value._small, sizeof(_small));
+        _smallSize = value._smallSize;
         _type = value._type;
         value._value = {};
         value._type = TjsValueType::Void;
         return *this;
     }
 
+    void TjsValue::assignString(const std::string_view value) {
+        static_assert(offsetof(TjsValue, _small) == sizeof(_value));
+
+        if(value.size() <= SMALL_STRING_CAPACITY) {
+            _smallSize = static_cast<uint8_t>(value.size());
+            std::memcpy(smallData(), value.data(), value.size());
+            return;
+        }
+        _smallSize = HEAP_STRING;
+        _value._string = TjsString::make(std::string{ value });
+    }
+
+    size_t TjsValue::stringSize() const {
+        return isSmallString() ? _smallSize : _value._string->size();
+    }
+
+    TjsString* TjsValue::toHeapString() const {
+        if(isSmallString()) {
+            return TjsString::make(std::string{ smallData(), _smallSize });
+        }
+        return _value._string->retain();
+    }
+
     TjsValue::~TjsValue() noexcept {
+        reset();
+    }
+
+    void TjsValue::reset() noexcept {
         switch(_type) {
             case TjsValueType::Object:                 
                // TODO: add GC 
                 break;
-            case TjsValueType::String: delete _value._string;
+            case TjsValueType::String:
+                if(!isSmallString()) TjsString::release(_value._string);
                 break;
-            case TjsValueType::Octet: delete _value._octet;
+            case TjsValueType::Octet: TjsOctet::release(_value._octet);
                 break;
             default: ;
         }
@@ -100,10 +159,32 @@ namespace Ciallang {
         return _value._real;
     }
 
-    std::string* TjsValue::asString() const {
+    std::string_view TjsValue::asString() const {
+        CHECK(this->_type == TjsValueType::String)
+        << "is not string " << "is " << name();
+        if(isSmallString()) return { smallData(), _smallSize };
+        return _value._string->view();
+    }
+
+    TjsString* TjsValue::asTjsString() const {
         CHECK(this->_type == TjsValueType::String)
         << "is not string " << "is " << name();
-        return _value._string;
+        return isSmallString() ? nullptr : _value._string;
+    }
+
+    // 字符串和其他值相加时转为字符串, void 视为空字符串
+    static TjsValue toStringOperand(const TjsValue& value) {
+        switch(value.type()) {
+            case TjsValueType::String:
+                return value;
+            case TjsValueType::Integer:
+            case TjsValueType::Real:
+                return TjsValue{ fmt::format("{}", value) };
+            case TjsValueType::Void:
+                return TjsValue{ std::string{} };
+            default:
+                throw std::logic_error("not support add operator with " + value.name());
+        }
     }
 
     TjsOctet* TjsValue::asOctet() const {
@@ -144,6 +225,27 @@ namespace Ciallang {
     }
 
     TjsValue TjsValue::operator+(const TjsValue& tjsValue) const {
+        if(_type == TjsValueType::String || tjsValue.type() == TjsValueType::String) {
+            const auto left = toStringOperand(*this);
+            const auto right = toStringOperand(tjsValue);
+
+            // 结果仍然是短字符串时直接拼在值里面
+            if(left.stringSize() + right.stringSize() <= SMALL_STRING_CAPACITY) {
+                TjsValue result{ std::string{} };
+                const auto leftView = left.asString();
+                const auto rightView = right.asString();
+                std::memcpy(result.smallData(), leftView.data(), leftView.size());
+                std::memcpy(result.smallData() + leftView.size(), rightView.data(), rightView.size());
+                result._smallSize = static_cast<uint8_t>(leftView.size() + rightView.size());
+                return result;
+            }
+            return TjsValue{ TjsString::concat(left.toHeapString(), right.toHeapString()) };
+        }
+
+        if(_type == TjsValueType::Octet && tjsValue.type() == TjsValueType::Octet) {
+            return TjsValue{ TjsOctet::concat(asOctet(), tjsValue.asOctet()) };
+        }
+
         switch(tjsValue.type()) {
             case TjsValueType::Integer:
                 return TjsValue{ this->asInteger() + tjsValue.asInteger() };
@@ -206,10 +308,11 @@ namespace Ciallang {
             case TjsValueType::Real:
                 return asReal() == tjsValue.asReal();
             case TjsValueType::String:
-                return *asString() == *tjsValue.asString();
+                return asString() == tjsValue.asString();
             case TjsValueType::Object:
                 return asObject() == tjsValue.asObject();
             case TjsValueType::Octet:
+                return asOctet()->compare(*tjsValue.asOctet()) == 0;
             default: ;
         }
 
@@ -222,6 +325,10 @@ namespace Ciallang {
            && tjsValue._type == TjsValueType::Integer) {
             return asInteger() <=> tjsValue.asInteger();
         }
+        if(_type == TjsValueType::Octet
+           && tjsValue._type == TjsValueType::Octet) {
+            return asOctet()->compare(*tjsValue.asOctet());
+        }
         if(_type != TjsValueType::String
            || tjsValue._type != TjsValueType::String) {
             return asReal() <=> tjsValue.asReal();
@@ -236,9 +343,15 @@ namespace Ciallang {
             case TjsValueType::Real:
                 return os << d.asReal();
             case TjsValueType::String:
-                return os << *d.asString();
-            case TjsValueType::Octet:
-                throw std::logic_error("not support");
+                return os << d.asString();
+            case TjsValueType::Octet: {
+                // 与字面量语法相同: <% 0a ff %>
+                os << "<%";
+                for(const auto byte : d.asOctet()->bytes()) {
+                    os << fmt::format(" {:02x}", byte);
+                }
+                return os << " %>";
+            }
             case TjsValueType::Object:
                 return os << "<object>[" << d.asObject()->name() << ']';
             case TjsValueType::Void:
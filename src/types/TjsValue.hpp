@@ -21,6 +21,9 @@ namespace Ciallang {
         friend struct TjsValueHelper;
 
     public:
+        // 不超过这个长度的字符串直接存放在值里面, 不分配 TjsString
+        static constexpr size_t SMALL_STRING_CAPACITY = 14;
+
         TjsValue() = default;
 
         explicit TjsValue(const TjsInteger& value);
@@ -29,7 +32,13 @@ namespace Ciallang {
 
         explicit TjsValue(const std::string&);
 
-        explicit TjsValue(const TjsOctet&);
+        explicit TjsValue(std::string&&);
+
+        // 接管 string 的一个引用
+        explicit TjsValue(TjsString* string);
+
+        // 接管 octet 的一个引用
+        explicit TjsValue(TjsOctet* octet);
 
         template <typename T>
             requires std::is_base_of_v<TjsObject, T>
@@ -56,7 +65,15 @@ namespace Ciallang {
 
         [[nodiscard]] TjsReal asReal() const;
 
-        [[nodiscard]] std::string* asString() const;
+        // rope 在这里展开; 返回的视图在值被修改或析构前有效
+        [[nodiscard]] std::string_view asString() const;
+
+        // 不展开 rope, 用于按片段读取或共享; 短字符串没有 TjsString, 返回 nullptr
+        [[nodiscard]] TjsString* asTjsString() const;
+
+        [[nodiscard]] bool isSmallString() const noexcept {
+            return _type == TjsValueType::String && _smallSize != HEAP_STRING;
+        }
 
         [[nodiscard]] TjsOctet* asOctet() const;
 
@@ -79,7 +96,7 @@ namespace Ciallang {
         }
 
         [[nodiscard]] bool isOctet() const {
-            return _type == TjsValueType::String;
+            return _type == TjsValueType::Octet;
         }
 
         [[nodiscard]] bool isObject() const {
@@ -108,13 +125,40 @@ namespace Ciallang {
         union {
             TjsInteger _integer;
             TjsReal _real;
-            std::string* _string;
+            TjsString* _string;
             TjsOctet* _octet;
             TjsObject* _object;
         } _value{};
 
+        // 短字符串从 _value 开始连续存放, 接着使用 _value 后面本来是填充的字节
+        char _small[SMALL_STRING_CAPACITY - sizeof(_value)]{};
+
+        // 短字符串的长度, HEAP_STRING 表示字符串在 _value._string 中
+        uint8_t _smallSize{ HEAP_STRING };
+
         TjsValueType _type{ TjsValueType::Void };
 
+        static constexpr uint8_t HEAP_STRING = 0xFF;
+
+        [[nodiscard]] char* smallData() noexcept {
+            return reinterpret_cast<char*>(&_value);
+        }
+
+        [[nodiscard]] const char* smallData() const noexcept {
+            return reinterpret_cast<const char*>(&_value);
+        }
+
+        void assignString(std::string_view value);
+
+        // 字符串长度, 不展开 rope
+        [[nodiscard]] size_t stringSize() const;
+
+        // 返回 TjsString 的一个引用, 短字符串在这里才分配
+        [[nodiscard]] TjsString* toHeapString() const;
+
+        // 释放持有的字符串等资源
+        void reset() noexcept;
+
         friend std::ostream& operator<<(std::ostream& os, const TjsValue& d);
     };
 
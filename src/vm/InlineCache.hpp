@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2024/10/29 下午8:31
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#pragma once
+
+#include "pch.h"
+
+#include "types/TjsStringTable.hpp"
+
+namespace Ciallang {
+    class TjsShape;
+}
+
+namespace Ciallang::Bytecode {
+    // 单个属性访问点最多缓存的形状数量, 超过后退化为 megamorphic
+    static constexpr size_t INLINE_CACHE_ENTRIES = 4;
+
+    // 全局 stub cache 的项数, 必须是 2 的幂
+    static constexpr size_t STUB_CACHE_SIZE = 1024;
+
+    enum class InlineCacheState : uint8_t {
+        Uninitialized,
+        Monomorphic,
+        Polymorphic,
+        Megamorphic
+    };
+
+    static constexpr std::string_view inlineCacheStateName(const InlineCacheState state) noexcept {
+        switch(state) {
+            case InlineCacheState::Uninitialized: return "uninit";
+            case InlineCacheState::Monomorphic: return "mono";
+            case InlineCacheState::Polymorphic: return "poly";
+            case InlineCacheState::Megamorphic: return "mega";
+        }
+        return "unknown";
+    }
+
+    /**
+     * 属性访问点的多态内联缓存, 记录最近见过的形状和对应的槽位.
+     * 见过的形状超过 INLINE_CACHE_ENTRIES 个后不再缓存, 改为查询解释器的 StubCache
+     */
+    class InlineCache {
+    public:
+        // 命中时返回槽位
+        std::optional<uint32_t> lookup(const TjsShape* shape) noexcept {
+            for(uint8_t i = 0; i < _size; ++i) {
+                if(_entries[i].shape == shape) {
+                    ++_hits;
+                    return _entries[i].slot;
+                }
+            }
+            ++_misses;
+            return {};
+        }
+
+        // 未命中后记录新的形状, 返回是否因此变为 megamorphic
+        bool update(const TjsShape* shape, const uint32_t slot) noexcept {
+            if(_megamorphic) return false;
+
+            if(_size == INLINE_CACHE_ENTRIES) {
+                _megamorphic = true;
+                _size = 0;
+                return true;
+            }
+
+            _entries[_size++] = { shape, slot };
+            return false;
+        }
+
+        [[nodiscard]] InlineCacheState state() const noexcept {
+            if(_megamorphic) return InlineCacheState::Megamorphic;
+            if(_size == 0) return InlineCacheState::Uninitialized;
+            return _size == 1 ? InlineCacheState::Monomorphic : InlineCacheState::Polymorphic;
+        }
+
+        [[nodiscard]] size_t hits() const noexcept { return _hits; }
+        [[nodiscard]] size_t misses() const noexcept { return _misses; }
+
+    private:
+        struct Entry {
+            const TjsShape* shape;
+            uint32_t slot;
+        };
+
+        std::array<Entry, INLINE_CACHE_ENTRIES> _entries{};
+        uint8_t _size{};
+        bool _megamorphic{};
+
+        size_t _hits{};
+        size_t _misses{};
+    };
+
+    /**
+     * megamorphic 访问点共享的 (形状, 属性名) -> 槽位缓存, 直接映射, 冲突时覆盖
+     */
+    class StubCache {
+    public:
+        std::optional<uint32_t> lookup(const TjsShape* shape,
+                                       const TjsInternedString name,
+                                       const size_t nameHash) const noexcept {
+            const auto& entry = _entries[index(shape, nameHash)];
+            if(entry.shape == shape && entry.name == name) {
+                return entry.slot;
+            }
+            return {};
+        }
+
+        void insert(const TjsShape* shape,
+                    const TjsInternedString name,
+                    const size_t nameHash,
+                    const uint32_t slot) noexcept {
+            _entries[index(shape, nameHash)] = { shape, name, slot };
+        }
+
+    private:
+        struct Entry {
+            const TjsShape* shape;
+            TjsInternedString name;
+            uint32_t slot;
+        };
+
+        std::array<Entry, STUB_CACHE_SIZE> _entries{};
+
+        static size_t index(const TjsShape* shape, const size_t nameHash) noexcept {
+            // 形状按对象大小对齐, 低位没有区分度
+            return ((reinterpret_cast<uintptr_t>(shape) >> 4) ^ nameHash) & (STUB_CACHE_SIZE - 1);
+        }
+    };
+
+    // 解释器中所有属性访问点的统计
+    struct InlineCacheStats {
+        size_t hits{};
+        size_t misses{};
+        size_t stubHits{};
+        size_t stubMisses{};
+        size_t megamorphicSites{};
+    };
+}
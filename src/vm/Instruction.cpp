@@ -15,8 +15,12 @@
 #include "Instruction.hpp"
 
 #include "Interpreter.hpp"
+#include "core/math.hpp"
+#include "core/print.hpp"
+#include "types/TjsArray.hpp"
 #include "types/TjsFunction.hpp"
 #include "types/TjsNativeFunction.hpp"
+#include "types/TjsScriptObject.hpp"
 
 namespace Ciallang::Bytecode::Op {
     void Load::execute(Interpreter& interpreter) const {
@@ -96,7 +100,7 @@ namespace Ciallang::Bytecode::Op {
     std::string DGlobal::dump(const Interpreter& interpreter, const bool info) const {
         auto insDump = fmt::format(
             "{: <10} {: <4} {: <4}", "dglobal",
-            _src, "\"" + _identifier + "\""
+            _src, "\"" + _identifier.str() + "\""
         );
 
         if(!info) return insDump;
@@ -115,14 +119,14 @@ namespace Ciallang::Bytecode::Op {
     std::string GGlobal::dump(const Interpreter& interpreter, const bool info) const {
         auto insDump = fmt::format(
             "{: <10} {: <4} {: <4}",
-            "gglobal", "\"" + _identifier + "\"", _dst
+            "gglobal", "\"" + _identifier.str() + "\"", _dst
         );
 
         if(!info) return insDump;
 
         return fmt::format(
             "{: <30} ; {} = {}",
-            insDump, "\"" + _identifier + "\"", interpreter.global(_identifier)
+            insDump, "\"" + _identifier.str() + "\"", interpreter.global(_identifier)
         );
     }
 
@@ -269,6 +273,250 @@ namespace Ciallang::Bytecode::Op {
         return fmt::format("{: <30} ; ZF = {}", insDump, interpreter.getZF());
     }
 
+    static TjsScriptObject* scriptObject(const TjsValue& value) {
+        if(!value.isObject() || !value.asObject()->shape()) {
+            throw std::logic_error("member access expects script object, but is " + value.name());
+        }
+        return static_cast<TjsScriptObject*>(value.asObject());
+    }
+
+    // 整数下标访问数组时走元素存储, 其他情况按成员名处理
+    static TjsArray* arrayObject(const TjsValue& object, const TjsValue& index) {
+        if(!object.isObject() || !index.isInteger()) return nullptr;
+        return dynamic_cast<TjsArray*>(object.asObject());
+    }
+
+    static std::string_view memberName(const TjsValue& value) {
+        if(!value.isString()) {
+            throw std::logic_error("member name expects string, but is " + value.name());
+        }
+        return value.asString();
+    }
+
+    // 依次查询访问点的内联缓存, 解释器的 stub cache 和对象的形状
+    static std::optional<uint32_t> findSlot(Interpreter& interpreter,
+                                            InlineCache& cache,
+                                            const TjsScriptObject* object,
+                                            const TjsInternedString name,
+                                            const size_t nameHash) {
+        auto& stats = interpreter.cacheStats();
+        const auto* shape = object->shape();
+
+        if(const auto slot = cache.lookup(shape)) {
+            ++stats.hits;
+            return slot;
+        }
+        ++stats.misses;
+
+        const bool megamorphic = cache.state() == InlineCacheState::Megamorphic;
+        if(megamorphic) {
+            if(const auto slot = interpreter.stubCache().lookup(shape, name, nameHash)) {
+                ++stats.stubHits;
+                return slot;
+            }
+            ++stats.stubMisses;
+        }
+
+        const auto slot = object->find(name);
+        if(!slot.has_value()) return {};
+
+        if(cache.update(shape, slot.value())) ++stats.megamorphicSites;
+
+        if(megamorphic || cache.state() == InlineCacheState::Megamorphic) {
+            interpreter.stubCache().insert(shape, name, nameHash, slot.value());
+        }
+        return slot;
+    }
+
+    static std::string dumpCache(const InlineCache& cache) {
+        return fmt::format(
+            "ic = {} ({}/{})",
+            inlineCacheStateName(cache.state()), cache.hits(), cache.hits() + cache.misses()
+        );
+    }
+
+    void GPD::execute(Interpreter& interpreter) const {
+        const auto* object = scriptObject(interpreter.reg(_obj));
+
+        if(const auto* dictionary = object->dictionary()) {
+            const auto* value = dictionary->find(_name);
+            interpreter.reg(_dst, value ? *value : TjsValue{});
+            return;
+        }
+
+        // 不存在的成员为 void
+        const auto slot = findSlot(interpreter, _cache, object, _name, _nameHash);
+        if(!slot.has_value()) {
+            interpreter.reg(_dst, TjsValue{});
+            return;
+        }
+
+        interpreter.reg(_dst, object->slot(slot.value()));
+    }
+
+    std::string GPD::dump(const Interpreter& interpreter, const bool info) const {
+        auto insDump = fmt::format("{: <10} {: <4} {}.*{}", "gpd", _dst, _obj, _name.str());
+
+        if(!info) return insDump;
+
+        return fmt::format(
+            "{: <30} ; {} = {}, {}",
+            insDump, _obj, interpreter.reg(_obj), dumpCache(_cache)
+        );
+    }
+
+    void GPI::execute(Interpreter& interpreter) const {
+        if(const auto* array = arrayObject(interpreter.reg(_obj), interpreter.reg(_name))) {
+            interpreter.reg(_dst, array->get(interpreter.reg(_name).asInteger()));
+            return;
+        }
+
+        const auto* object = scriptObject(interpreter.reg(_obj));
+
+        // 运行时拼出的名字只查询, 不驻留
+        const auto* value = object->get(memberName(interpreter.reg(_name)));
+        interpreter.reg(_dst, value ? *value : TjsValue{});
+    }
+
+    std::string GPI::dump(const Interpreter&, bool) const {
+        return fmt::format("{: <10} {: <4} {}.{}", "gpi", _dst, _obj, _name);
+    }
+
+    void SPD::execute(Interpreter& interpreter) const {
+        auto* object = scriptObject(interpreter.reg(_obj));
+        TjsValue value{ interpreter.reg(_src) };
+
+        if(auto* dictionary = object->dictionary()) {
+            if(!_create && !dictionary->contains(_name)) {
+                throw std::logic_error("member not found: " + _name.str());
+            }
+            dictionary->insertOrAssign(_name, std::move(value));
+            return;
+        }
+
+        if(_create && object->shape() == _from) {
+            object->transition(_to, std::move(value));
+            return;
+        }
+
+        if(const auto slot = findSlot(interpreter, _cache, object, _name, _nameHash)) {
+            object->slot(slot.value(), std::move(value));
+            return;
+        }
+
+        if(!_create) {
+            throw std::logic_error("member not found: " + _name.str());
+        }
+
+        const auto* from = object->shape();
+        object->define(_name, std::move(value));
+
+        // 转为字典模式的迁移不能缓存
+        if(!object->dictionary()) {
+            _from = from;
+            _to = object->shape();
+        }
+    }
+
+    std::string SPD::dump(const Interpreter&, const bool info) const {
+        auto insDump = fmt::format("{: <10} {}.*{: <4} {}", _create ? "spde" : "spd", _obj, _name.str(), _src);
+
+        if(!info) return insDump;
+
+        return fmt::format("{: <30} ; {}", insDump, dumpCache(_cache));
+    }
+
+    void SPI::execute(Interpreter& interpreter) const {
+        if(auto* array = arrayObject(interpreter.reg(_obj), interpreter.reg(_name))) {
+            array->set(interpreter.reg(_name).asInteger(), TjsValue{ interpreter.reg(_src) });
+            return;
+        }
+
+        auto* object = scriptObject(interpreter.reg(_obj));
+        const auto key = memberName(interpreter.reg(_name));
+        TjsValue value{ interpreter.reg(_src) };
+
+        // 只有 spie 会添加成员, 需要驻留; 没有驻留过的名字不可能是已有的成员
+        const auto name = _create ? TjsStringTable::intern(key) : TjsStringTable::find(key);
+        if(!_create && (!name || !object->get(name))) {
+            throw std::logic_error("member not found: " + std::string{ key });
+        }
+
+        object->set(name, std::move(value));
+    }
+
+    std::string SPI::dump(const Interpreter&, bool) const {
+        return fmt::format("{: <10} {}.{: <4} {}", _create ? "spie" : "spi", _obj, _name, _src);
+    }
+
+    static void checkArity(const TjsNativeFunction& native, const size_t count) {
+        if(count < native.arity()) {
+            throw std::logic_error(fmt::format(
+                "{} expects {} arguments, got {}", native.name(), native.arity(), count
+            ));
+        }
+    }
+
+    // 全局 name 仍然是回调为 callback 的内建函数
+    static bool isBuiltin(const Interpreter& interpreter,
+                          const TjsInternedString name,
+                          const TjsNativeFunction::Callback callback) {
+        const auto* value = interpreter.findGlobal(name);
+        if(!value || !value->isObject()) return false;
+
+        const auto* native = dynamic_cast<const TjsNativeFunction*>(value->asObject());
+        return native && native->callback() == callback;
+    }
+
+    // 内建函数被替换或者没有注册时按普通调用执行, 与 gglobal + call 的结果相同.
+    // 内建函数的参数寄存器不一定连续, 原生函数的参数先复制到临时数组
+    static void callGlobal(Interpreter& interpreter,
+                           const TjsInternedString name,
+                           const std::initializer_list<Register> arguments,
+                           const Register dst) {
+        const auto& object = interpreter.global(name);
+        if(!object.isObject()) {
+            throw std::logic_error(fmt::format("{} is not callable", object));
+        }
+
+        if(!object.asObject()->isNative()) {
+            const auto fun = dynamic_cast<TjsFunction*>(object.asObject());
+
+            CHECK_NOTNULL(fun);
+            auto callFrame = interpreter.createCallFrame(fun->chunk(), dst);
+
+            uint32_t index{};
+            for(const auto reg : arguments) {
+                // copy
+                auto value = interpreter.reg(reg);
+
+                if(!value.isVoid()) {
+                    interpreter.applyArgument(callFrame, Register { index }, value);
+                }
+                ++index;
+            }
+
+            interpreter.pushCallFrame(std::move(callFrame));
+            return;
+        }
+
+        const auto* native = dynamic_cast<TjsNativeFunction*>(object.asObject());
+        if(!native) {
+            throw std::logic_error(fmt::format("{} is not callable", object));
+        }
+        checkArity(*native, arguments.size());
+
+        std::vector<TjsValue> values{};
+        values.reserve(arguments.size());
+        for(const auto reg : arguments) {
+            values.emplace_back(interpreter.reg(reg));
+        }
+
+        TjsValue ret{};
+        native->call(interpreter, values, &ret);
+        interpreter.reg(dst, std::move(ret));
+    }
+
     void Call::execute(Interpreter& interpreter) const {
         const auto& object = interpreter.reg(_memberReg);
         CHECK(object.isObject());
@@ -279,9 +527,9 @@ namespace Ciallang::Bytecode::Op {
             CHECK_NOTNULL(fun);
             auto callFrame = interpreter.createCallFrame(fun->chunk(), _dst);
 
-            for(uint32_t i = 0; i < _arguments.size(); i++) {
+            for(uint32_t i = 0; i < _count; i++) {
                 // copy
-                auto value = interpreter.reg(_arguments[i]);
+                auto value = interpreter.reg(Register { _first.index() + i });
 
                 if(value.isVoid()) continue;
 
@@ -291,9 +539,17 @@ namespace Ciallang::Bytecode::Op {
             interpreter.pushCallFrame(std::move(callFrame));
             return;
         }
-        
-        dynamic_cast<TjsNativeFunction*>(object.asObject())
-                    ->callProc(&interpreter.reg(_arguments.front()));
+
+        const auto* native = dynamic_cast<TjsNativeFunction*>(object.asObject());
+        if(!native) {
+            throw std::logic_error(fmt::format("{} is not callable", object));
+        }
+        checkArity(*native, _count);
+
+        // 先取目标寄存器, 分配寄存器可能使参数 span 失效
+        auto* ret = interpreter.regSlot(_dst);
+        *ret = TjsValue{};
+        native->call(interpreter, interpreter.regs(_first, _count), ret);
     }
 
     std::string Call::dump(const Interpreter&, bool) const {
@@ -301,12 +557,70 @@ namespace Ciallang::Bytecode::Op {
         ss << fmt::format("{: <10} {: <4} {: <4}",
             "call", _memberReg, _dst
         );
-        for(auto &argument : _arguments) {
-            ss << fmt::format("{: <4}", argument);
+        for(uint32_t i = 0; i < _count; i++) {
+            ss << fmt::format("{: <4}", Register { _first.index() + i });
         }
         return ss.str();
     }
 
+    void Print::execute(Interpreter& interpreter) const {
+        const auto& builtin = _newline ? Core::S_PrintlnFunction : Core::S_PrintFunction;
+        if(!isBuiltin(interpreter, _name, builtin.callback())) {
+            callGlobal(interpreter, _name, { _src }, _dst);
+            return;
+        }
+
+        if(_newline) {
+            Core::printlnValue(interpreter.reg(_src));
+        } else {
+            Core::printValue(interpreter.reg(_src));
+        }
+        interpreter.reg(_dst, TjsValue{});
+    }
+
+    std::string Print::dump(const Interpreter&, bool) const {
+        return fmt::format("{: <10} {: <4} {: <4}", _newline ? "println" : "print", _src, _dst);
+    }
+
+    void MathAbs::execute(Interpreter& interpreter) const {
+        if(!isBuiltin(interpreter, _name, Core::S_MathAbsFunction.callback())) {
+            callGlobal(interpreter, _name, { _src }, _dst);
+            return;
+        }
+
+        interpreter.reg(_dst, Core::mathAbs(interpreter.reg(_src)));
+    }
+
+    std::string MathAbs::dump(const Interpreter&, bool) const {
+        return fmt::format("{: <10} {: <4} {: <4}", "abs", _src, _dst);
+    }
+
+    void MathMin::execute(Interpreter& interpreter) const {
+        if(!isBuiltin(interpreter, _name, Core::S_MathMinFunction.callback())) {
+            callGlobal(interpreter, _name, { _reg1, _reg2 }, _dst);
+            return;
+        }
+
+        interpreter.reg(_dst, Core::mathMin(interpreter.reg(_reg1), interpreter.reg(_reg2)));
+    }
+
+    std::string MathMin::dump(const Interpreter&, bool) const {
+        return fmt::format("{: <10} {: <4} {: <4} {: <4}", "min", _reg1, _reg2, _dst);
+    }
+
+    void MathMax::execute(Interpreter& interpreter) const {
+        if(!isBuiltin(interpreter, _name, Core::S_MathMaxFunction.callback())) {
+            callGlobal(interpreter, _name, { _reg1, _reg2 }, _dst);
+            return;
+        }
+
+        interpreter.reg(_dst, Core::mathMax(interpreter.reg(_reg1), interpreter.reg(_reg2)));
+    }
+
+    std::string MathMax::dump(const Interpreter&, bool) const {
+        return fmt::format("{: <10} {: <4} {: <4} {: <4}", "max", _reg1, _reg2, _dst);
+    }
+
     void Ret::execute(Interpreter& interpreter) const {
         // copy
         auto value = interpreter.reg(_retReg.value());
@@ -13,12 +13,18 @@
  */
 #pragma once
 
+#include "InlineCache.hpp"
 #include "Label.hpp"
 #include "pch.h"
 #include "Register.hpp"
 
+#include "types/TjsStringTable.hpp"
 #include "types/TjsValue.hpp"
 
+namespace Ciallang {
+    class TjsShape;
+}
+
 namespace Ciallang::Bytecode {
     class Interpreter;
 }
@@ -145,9 +151,9 @@ namespace Ciallang::Bytecode::Op {
     class DGlobal final : public Instruction {
     public:
         explicit DGlobal(
-            std::string&& identifier,
+            const TjsInternedString identifier,
             const Register src
-        ) : _src(src), _identifier(std::move(identifier)) {
+        ) : _src(src), _identifier(identifier) {
         }
 
         void execute(Interpreter&) const override;
@@ -156,13 +162,13 @@ namespace Ciallang::Bytecode::Op {
 
     private:
         const Register _src;
-        const std::string _identifier;
+        const TjsInternedString _identifier;
     };
 
     class GGlobal final : public Instruction {
     public:
         explicit GGlobal(
-            std::string&& identifier,
+            const TjsInternedString identifier,
             const Register dst
         ) : _identifier(identifier), _dst(dst) {
         }
@@ -172,7 +178,7 @@ namespace Ciallang::Bytecode::Op {
         std::string dump(const Interpreter&, bool) const override;
 
     private:
-        const std::string _identifier;
+        const TjsInternedString _identifier;
         const Register _dst;
     };
 
@@ -367,13 +373,118 @@ namespace Ciallang::Bytecode::Op {
         std::optional<Label> _label;
     };
 
+    // gpd %dst, %obj.*name
+    class GPD final : public Instruction {
+    public:
+        explicit GPD(
+            const Register dst,
+            const Register obj,
+            const TjsInternedString name
+        ) : _dst(dst), _obj(obj), _name(name),
+            _nameHash(std::hash<TjsInternedString>{}(name)) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+        [[nodiscard]] const InlineCache& cache() const noexcept { return _cache; }
+
+    private:
+        const Register _dst;
+        const Register _obj;
+        const TjsInternedString _name;
+        const size_t _nameHash;
+
+        mutable InlineCache _cache{};
+    };
+
+    // gpi %dst, %obj.%name
+    class GPI final : public Instruction {
+    public:
+        explicit GPI(
+            const Register dst,
+            const Register obj,
+            const Register name
+        ) : _dst(dst), _obj(obj), _name(name) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+    private:
+        const Register _dst;
+        const Register _obj;
+        const Register _name;
+    };
+
+    // spd %obj.*name, %src   成员不存在时报错
+    // spde %obj.*name, %src  成员不存在时添加
+    class SPD final : public Instruction {
+    public:
+        explicit SPD(
+            const Register obj,
+            const TjsInternedString name,
+            const Register src,
+            const bool create
+        ) : _obj(obj), _name(name),
+            _nameHash(std::hash<TjsInternedString>{}(name)), _src(src), _create(create) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+        [[nodiscard]] const InlineCache& cache() const noexcept { return _cache; }
+
+    private:
+        const Register _obj;
+        const TjsInternedString _name;
+        const size_t _nameHash;
+        const Register _src;
+        const bool _create;
+
+        // 写入已有成员
+        mutable InlineCache _cache{};
+
+        // 上一次添加成员时的形状迁移
+        mutable const TjsShape* _from{ nullptr };
+        mutable TjsShape* _to{ nullptr };
+    };
+
+    // spi %obj.%name, %src
+    // spie %obj.%name, %src
+    class SPI final : public Instruction {
+    public:
+        explicit SPI(
+            const Register obj,
+            const Register name,
+            const Register src,
+            const bool create
+        ) : _obj(obj), _name(name), _src(src), _create(create) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+    private:
+        const Register _obj;
+        const Register _name;
+        const Register _src;
+        const bool _create;
+    };
+
+    // call %member, %dst, %first..+count  参数位于从 first 开始的连续寄存器
     class Call final : public Instruction {
     public:
         explicit Call(
             const Register dst,
             const Register memberReg,
-            std::vector<Register>&& arguments
-        ) : _dst(dst), _memberReg(memberReg), _arguments(arguments) {
+            const Register first,
+            const uint32_t count
+        ) : _dst(dst), _memberReg(memberReg), _first(first), _count(count) {
         }
 
         void execute(Interpreter&) const override;
@@ -383,7 +494,98 @@ namespace Ciallang::Bytecode::Op {
     private:
         const Register _dst;
         const Register _memberReg;
-        const std::vector<Register> _arguments;
+        const Register _first;
+        const uint32_t _count;
+    };
+
+    // 内建函数的专用指令, 由字节码生成器在调用未被覆盖的内建函数时生成.
+    // 执行时先检查全局 name 是否仍是内建函数, 宿主替换了它或者没有注册时按普通调用执行
+
+    // print %src, %dst
+    // println %src, %dst
+    class Print final : public Instruction {
+    public:
+        explicit Print(
+            const TjsInternedString name,
+            const Register src,
+            const Register dst,
+            const bool newline
+        ) : _name(name), _src(src), _dst(dst), _newline(newline) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+    private:
+        const TjsInternedString _name;
+        const Register _src;
+        const Register _dst;
+        const bool _newline;
+    };
+
+    // abs %src, %dst
+    class MathAbs final : public Instruction {
+    public:
+        explicit MathAbs(
+            const TjsInternedString name,
+            const Register src,
+            const Register dst
+        ) : _name(name), _src(src), _dst(dst) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+    private:
+        const TjsInternedString _name;
+        const Register _src;
+        const Register _dst;
+    };
+
+    // min %reg1, %reg2, %dst
+    class MathMin final : public Instruction {
+    public:
+        explicit MathMin(
+            const TjsInternedString name,
+            const Register reg1,
+            const Register reg2,
+            const Register dst
+        ) : _name(name), _reg1(reg1), _reg2(reg2), _dst(dst) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+    private:
+        const TjsInternedString _name;
+        const Register _reg1;
+        const Register _reg2;
+        const Register _dst;
+    };
+
+    // max %reg1, %reg2, %dst
+    class MathMax final : public Instruction {
+    public:
+        explicit MathMax(
+            const TjsInternedString name,
+            const Register reg1,
+            const Register reg2,
+            const Register dst
+        ) : _name(name), _reg1(reg1), _reg2(reg2), _dst(dst) {
+        }
+
+        void execute(Interpreter&) const override;
+
+        std::string dump(const Interpreter&, bool) const override;
+
+    private:
+        const TjsInternedString _name;
+        const Register _reg1;
+        const Register _reg2;
+        const Register _dst;
     };
 
     class Ret final : public Instruction {
@@ -15,8 +15,12 @@
 
 #include "pch.h"
 
+#include <span>
+
 #include "Chunk.hpp"
+#include "InlineCache.hpp"
 #include "collections/ConservativeVector.hpp"
+#include "types/TjsDictionary.hpp"
 #include "types/TjsFunction.hpp"
 
 #include "types/TjsValue.hpp"
@@ -84,12 +88,51 @@ namespace Ciallang::Bytecode {
             return _registers[index];
         }
 
+        // 原生函数直接写入的目标寄存器, 必须在取参数 span 之前调用, 扩容会使其失效
+        TjsValue* regSlot(const Register reg) {
+            auto index = reg.index()
+                + _currentFrame->registersOffset;
+            allocReigsers(index);
+
+            ++_logicRegistersSize;
+            return &_registers[index];
+        }
+
+        // 从 first 开始的 count 个连续寄存器
+        std::span<const TjsValue> regs(const Register first, const uint32_t count) const {
+            if(count == 0) return {};
+
+            auto index = first.index()
+                + _currentFrame->registersOffset;
+
+            DCHECK_LE(index + count, _registers.size());
+
+            return { &_registers[index], count };
+        }
+
+        const TjsValue& global(const TjsInternedString identifier) const {
+            const auto* value = _globals.get(identifier);
+            if(!value) throw std::out_of_range("undefined global: " + identifier.str());
+            return *value;
+        }
+
+        // 没有这个全局变量时返回 nullptr
+        const TjsValue* findGlobal(const TjsInternedString identifier) const {
+            return _globals.get(identifier);
+        }
+
         const TjsValue& global(const std::string& identifier) const {
-            return _globals.at(identifier);
+            const auto interned = TjsStringTable::find(identifier);
+            if(!interned) throw std::out_of_range("undefined global: " + identifier);
+            return global(interned);
+        }
+
+        void global(const TjsInternedString identifier, TjsValue&& value) {
+            _globals.set(identifier, std::move(value));
         }
 
         void global(const std::string& identifier, TjsValue&& value) {
-            _globals[identifier] = std::move(value);
+            global(TjsStringTable::intern(identifier), std::move(value));
         }
 
         void setZF(const bool zf) { _ZF = zf; }
@@ -169,6 +212,23 @@ namespace Ciallang::Bytecode {
             return ss.str();
         }
 
+        StubCache& stubCache() noexcept { return _stubCache; }
+
+        InlineCacheStats& cacheStats() noexcept { return _cacheStats; }
+
+        [[nodiscard]] const InlineCacheStats& cacheStats() const noexcept { return _cacheStats; }
+
+        std::string dumpCacheStats() const {
+            const size_t total = _cacheStats.hits + _cacheStats.misses;
+            return fmt::format(
+                "inline cache: {} hits, {} misses ({:.1f}% hit), "
+                "stub cache: {} hits, {} misses, megamorphic sites: {}\n",
+                _cacheStats.hits, _cacheStats.misses,
+                total == 0 ? 0.0 : static_cast<double>(_cacheStats.hits) / static_cast<double>(total) * 100,
+                _cacheStats.stubHits, _cacheStats.stubMisses, _cacheStats.megamorphicSites
+            );
+        }
+
         void allocReigsers(const size_t index) {
             if (index >= _registers.size()) {
                 _registers.resize(index + 1);
@@ -181,7 +241,10 @@ namespace Ciallang::Bytecode {
         Collections::ConservativeVector<CallFrame> _callStack{};
         Collections::ConservativeVector<TjsValue> _registers{};
         uint32_t _logicRegistersSize{};
-        std::unordered_map<std::string, TjsValue> _globals{};
+        TjsDictionary _globals{};
+
+        StubCache _stubCache{};
+        InlineCacheStats _cacheStats{};
 
         bool _ZF{ false };
 
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2024/10/25 下午9:16
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <random>
+
+#include "../src/gc/Generational.hpp"
+#include "../src/init/GlogInit.hpp"
+
+/**
+ * GC 基准测试, 对每个负载输出分配吞吐量, 停顿时间分位数和进程的峰值 RSS
+ *
+ *     gc_bench --bench_workload=binary-trees --bench_scale=2
+ *     gc_bench --gc_torture --bench_scale=0   # 每次分配都回收, 检查根和写屏障
+ *     gc_bench --bench_workload=mark-scaling  # 老年代并行标记在不同线程数下的耗时
+ *
+ * 峰值 RSS 是整个进程的, 需要单独比较时每次只运行一个负载
+ */
+
+DEFINE_string(bench_workload, "all", "binary-trees, list-churn, large-array, promotion, mark-scaling or all");
+
+DEFINE_uint32(bench_scale, 1, "workload size multiplier, 0 runs a tiny smoke test");
+
+DEFINE_uint64(bench_heap_size, 16 * 1024 * 1024, "initial heap size in bytes");
+
+using namespace Ciallang::GC;
+
+namespace {
+    class TreeNode final : public GCObject {
+    public:
+        TreeNode* left{ nullptr };
+        TreeNode* right{ nullptr };
+
+        void trace(const FieldVisitor& visitor) override {
+            traceField(visitor, left);
+            traceField(visitor, right);
+        }
+
+        size_t size() const noexcept override { return sizeof(TreeNode); }
+
+        GCObject* copyTo(uint8_t* to) override { return new(to) TreeNode{ *this }; }
+    };
+
+    class ListNode final : public GCObject {
+    public:
+        explicit ListNode(const size_t value) : value(value) {
+        }
+
+        ListNode* next{ nullptr };
+        size_t value;
+
+        void trace(const FieldVisitor& visitor) override {
+            traceField(visitor, next);
+        }
+
+        size_t size() const noexcept override { return sizeof(ListNode); }
+
+        GCObject* copyTo(uint8_t* to) override { return new(to) ListNode{ *this }; }
+    };
+
+    // 对象不能超过一个 cell, 大数组由多个定长的块组成
+    class ArrayChunk final : public GCObject {
+    public:
+        static constexpr size_t LENGTH = 8;
+
+        GCObject* slots[LENGTH]{};
+
+        void trace(const FieldVisitor& visitor) override {
+            for(auto& slot : slots) {
+                visitor(slot);
+            }
+        }
+
+        size_t size() const noexcept override { return sizeof(ArrayChunk); }
+
+        GCObject* copyTo(uint8_t* to) override { return new(to) ArrayChunk{ *this }; }
+    };
+
+    class Workload {
+    public:
+        explicit Workload(Generational& gc) : gc(gc), roots(gc.allocateRoots()) {
+        }
+
+        template <typename T, typename... Args>
+        T* allocate(Args&&... args) {
+            ++allocations;
+            allocatedBytes += sizeof(T);
+            return gc.allocateNewSpace<T>(std::forward<Args>(args)...);
+        }
+
+        template <typename T>
+        void store(GCObject* obj, T*& field, T* value) {
+            gc.updatePtr(obj, &field, value);
+        }
+
+        Generational& gc;
+        Roots& roots;
+
+        size_t allocations{};
+        size_t allocatedBytes{};
+    };
+
+    // 返回的指针在下一次分配前有效
+    TreeNode* buildTree(Workload& w, const size_t depth) {
+        if(depth == 0) return w.allocate<TreeNode>();
+
+        w.roots.push_back(buildTree(w, depth - 1));
+        w.roots.push_back(buildTree(w, depth - 1));
+
+        auto* node = w.allocate<TreeNode>();
+        w.store(node, node->right, static_cast<TreeNode*>(w.roots.back()));
+        w.roots.pop_back();
+        w.store(node, node->left, static_cast<TreeNode*>(w.roots.back()));
+        w.roots.pop_back();
+        return node;
+    }
+
+    size_t countTree(const TreeNode* node) {
+        return node ? 1 + countTree(node->left) + countTree(node->right) : 0;
+    }
+
+    // 一棵长期存活的树, 加上大量短命的树
+    void binaryTrees(Workload& w, const size_t scale) {
+        const size_t maxDepth = scale == 0 ? 6 : 12 + scale;
+
+        w.roots.push_back(buildTree(w, maxDepth));
+
+        for(size_t depth = 4; depth <= maxDepth; depth += 2) {
+            const size_t iterations = size_t{ 1 } << (maxDepth - depth + 4);
+            for(size_t i = 0; i < iterations; ++i) {
+                CHECK_EQ(countTree(buildTree(w, depth)), (size_t{ 2 } << depth) - 1);
+            }
+        }
+
+        CHECK_EQ(countTree(static_cast<TreeNode*>(w.roots.back())), (size_t{ 2 } << maxDepth) - 1);
+    }
+
+    // 定长队列, 尾部追加, 头部丢弃. 老年代的尾节点不断引用新生代的新节点
+    void listChurn(Workload& w, const size_t scale) {
+        const size_t length = scale == 0 ? 64 : 10000;
+        const size_t steps = scale == 0 ? 1000 : 2000000 * scale;
+
+        w.roots.assign(2, nullptr);
+        auto head = [&] { return static_cast<ListNode*>(w.roots[0]); };
+        auto tail = [&] { return static_cast<ListNode*>(w.roots[1]); };
+
+        for(size_t i = 0; i < steps; ++i) {
+            auto* node = w.allocate<ListNode>(i);
+            if(tail()) {
+                w.store(tail(), tail()->next, node);
+            } else {
+                w.roots[0] = node;
+            }
+            w.roots[1] = node;
+
+            if(i >= length) w.roots[0] = head()->next;
+        }
+
+        size_t count = 0;
+        for(auto* node = head(); node; node = node->next) {
+            CHECK_EQ(node->value, steps - length + count);
+            ++count;
+        }
+        CHECK_EQ(count, length);
+    }
+
+    // 大数组中随机替换元素
+    void largeArray(Workload& w, const size_t scale) {
+        const size_t chunks = scale == 0 ? 16 : 8192 * scale;
+        const size_t writes = scale == 0 ? 1000 : 2000000 * scale;
+
+        w.roots.clear();
+        for(size_t i = 0; i < chunks; ++i) {
+            w.roots.push_back(w.allocate<ArrayChunk>());
+        }
+
+        std::mt19937_64 random{ 42 };
+        for(size_t i = 0; i < writes; ++i) {
+            const size_t index = random() % (chunks * ArrayChunk::LENGTH);
+            auto* node = w.allocate<ListNode>(index);
+            auto* chunk = static_cast<ArrayChunk*>(w.roots[index / ArrayChunk::LENGTH]);
+            w.store(chunk, chunk->slots[index % ArrayChunk::LENGTH], static_cast<GCObject*>(node));
+        }
+
+        for(size_t i = 0; i < chunks * ArrayChunk::LENGTH; ++i) {
+            const auto* chunk = static_cast<ArrayChunk*>(w.roots[i / ArrayChunk::LENGTH]);
+            if(const auto* node = static_cast<const ListNode*>(chunk->slots[i % ArrayChunk::LENGTH])) {
+                CHECK_EQ(node->value, i);
+            }
+        }
+    }
+
+    // 存活时间比几次 minor GC 更长的对象, 几乎全部晋升后在老年代死亡
+    void promotion(Workload& w, const size_t scale) {
+        const size_t window = scale == 0 ? 256 : 200000;
+        const size_t steps = scale == 0 ? 2000 : 2000000 * scale;
+
+        w.roots.assign(window, nullptr);
+        for(size_t i = 0; i < steps; ++i) {
+            w.roots[i % window] = w.allocate<ListNode>(i);
+        }
+
+        for(size_t i = 0; i < window; ++i) {
+            CHECK_EQ(static_cast<ListNode*>(w.roots[i])->value % window, i);
+        }
+    }
+
+    TreeNode* makeTree(MarkSweep& ms, const size_t depth) {
+        auto* node = ms.allocate<TreeNode>();
+        if(depth > 0) {
+            node->left = makeTree(ms, depth - 1);
+            node->right = makeTree(ms, depth - 1);
+        }
+        return node;
+    }
+
+    // 直接在老年代上构造多棵存活的树, 每种线程数完整标记一次
+    void markScaling(const size_t scale) {
+        const size_t depth = scale == 0 ? 8 : 13 + scale;
+        constexpr size_t treeCount = 8;
+        const size_t treeBytes = ((size_t{ 2 } << depth) - 1) * sizeof(TreeNode);
+        const size_t heapSize = NODE_SIZE * (size_t{ 2 } << depth) * (treeCount + 1);
+        auto* heap = static_cast<uint8_t*>(malloc(heapSize));
+
+        {
+            Roots roots{};
+            std::vector<Roots*> rootsSet{ &roots };
+            auto* tail = MarkSweep::initFreeList(heapSize, heap);
+            MarkSweep ms{ reinterpret_cast<Cell*>(heap), tail, rootsSet };
+
+            for(size_t i = 0; i < treeCount; ++i) {
+                roots.push_back(makeTree(ms, depth));
+            }
+
+            fmt::println("\n{: <10}{: >12}", "threads", "mark(us)");
+            for(const size_t threads : { 1, 2, 4, 8 }) {
+                // 每一轮都有一棵树变成垃圾
+                makeTree(ms, depth);
+                const size_t freedBytes = ms.freedBytes();
+
+                ms.markThreads(threads);
+                const auto begin = MarkSweep::Clock::now();
+                ms.collect();
+                const auto elapsed = MarkSweep::Clock::now() - begin;
+                ms.sweep();
+
+                CHECK_EQ(ms.freedBytes() - freedBytes, treeBytes);
+                fmt::println("{: <10}{: >12}", threads,
+                             std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+            }
+        }
+
+        free(heap);
+    }
+
+    size_t peakRss() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss;
+#else
+        return usage.ru_maxrss * 1024;
+#endif
+#endif
+    }
+
+    double percentile(const std::vector<GCTracer::Clock::duration>& sorted, const double p) {
+        using Millis = std::chrono::duration<double, std::milli>;
+        if(sorted.empty()) return 0.0;
+
+        const auto index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return Millis{ sorted[index] }.count();
+    }
+
+    void run(const std::string& name, void (*workload)(Workload&, size_t)) {
+        Generational gc{ FLAGS_bench_heap_size };
+        gc.tracing(true);
+
+        Workload w{ gc };
+
+        const auto begin = std::chrono::steady_clock::now();
+        workload(w, FLAGS_bench_scale);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+        auto pauses = gc.tracer()->durations();
+        std::ranges::sort(pauses);
+
+        const auto stats = gc.stats();
+        fmt::println(
+            "{: <14} {: >9.1f} {: >11.2f} {: >7} {: >9.3f} {: >9.3f} {: >9.3f} {: >9.3f} {: >8} {: >10}",
+            name,
+            static_cast<double>(w.allocatedBytes) / (1024 * 1024) / elapsed.count(),
+            static_cast<double>(w.allocations) / 1e6 / elapsed.count(),
+            pauses.size(),
+            percentile(pauses, 0.5),
+            percentile(pauses, 0.9),
+            percentile(pauses, 0.99),
+            percentile(pauses, 1.0),
+            stats.promotedBytes / 1024,
+            peakRss() / 1024
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    Ciallang::Init::InitializeGlog(argc, argv);
+
+    const std::pair<std::string, void (*)(Workload&, size_t)> workloads[] = {
+            { "binary-trees", binaryTrees },
+            { "list-churn", listChurn },
+            { "large-array", largeArray },
+            { "promotion", promotion },
+    };
+
+    fmt::println(
+        "{: <14} {: >9} {: >11} {: >7} {: >9} {: >9} {: >9} {: >9} {: >8} {: >10}",
+        "workload", "MB/s", "Mallocs/s", "pauses", "p50(ms)", "p90(ms)", "p99(ms)", "max(ms)", "promo(K)", "peakRSS(K)"
+    );
+
+    bool found = false;
+    for(const auto& [name, workload] : workloads) {
+        if(FLAGS_bench_workload != "all" && FLAGS_bench_workload != name) continue;
+
+        found = true;
+        run(name, workload);
+    }
+
+    if(FLAGS_bench_workload == "all" || FLAGS_bench_workload == "mark-scaling") {
+        found = true;
+        markScaling(FLAGS_bench_scale);
+    }
+
+    if(!found) {
+        LOG(ERROR) << "Unknown workload: " << FLAGS_bench_workload;
+        return 1;
+    }
+    return 0;
+}
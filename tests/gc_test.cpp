@@ -26,8 +26,6 @@ public:
         return sizeof(Dept);
     }
 
-    std::optional<std::vector<GCObject*>> getFields() const override { return {}; }
-
     GCObject* copyTo(uint8_t* to) override {
         return new(to) Dept{ *this };
     }
@@ -39,20 +37,8 @@ public:
     std::string name{ "emp_object" };
     Dept* dept{ nullptr };
 
-    std::optional<std::vector<GCObject*>> getFields() const override {
-        if(!dept) return {};
-
-        auto fields = std::vector<GCObject*>{};
-        auto childrenFields = dept->getFields();
-        if(childrenFields.has_value()) {
-            fields.insert(
-                fields.end(),
-                childrenFields.value().begin(),
-                childrenFields.value().end()
-            );
-        }
-        fields.push_back(dept);
-        return fields;
+    void trace(const FieldVisitor& visitor) override {
+        traceField(visitor, dept);
     }
 
     constexpr size_t size() const noexcept override {
@@ -68,6 +54,51 @@ public:
     }
 };
 
+class Tree final : public GCObject {
+public:
+    Tree* left{ nullptr };
+    Tree* right{ nullptr };
+
+    void trace(const FieldVisitor& visitor) override {
+        traceField(visitor, left);
+        traceField(visitor, right);
+    }
+
+    constexpr size_t size() const noexcept override {
+        return sizeof(Tree);
+    }
+
+    GCObject* copyTo(uint8_t* to) override {
+        return new(to) Tree{ *this };
+    }
+};
+
+// 单独测试老年代: 在 malloc 的堆上构造 MarkSweep.
+// 成员按声明的逆序析构, MarkSweep 先于堆释放, ASSERT_* 提前返回也不会泄漏
+struct OldSpace {
+    explicit OldSpace(const size_t heapSize) :
+        heap(static_cast<uint8_t*>(malloc(heapSize)), &free),
+        ms(reinterpret_cast<Cell*>(heap.get()), MarkSweep::initFreeList(heapSize, heap.get()), rootsSet) {
+    }
+
+    OldSpace(const OldSpace&) = delete;
+    OldSpace& operator=(const OldSpace&) = delete;
+
+    std::unique_ptr<uint8_t, decltype(&free)> heap;
+    Roots roots{};
+    std::vector<Roots*> rootsSet{ &roots };
+    MarkSweep ms;
+};
+
+static Tree* makeTree(MarkSweep& ms, const size_t depth) {
+    auto* tree = ms.allocate<Tree>();
+    if(depth > 0) {
+        tree->left = makeTree(ms, depth - 1);
+        tree->right = makeTree(ms, depth - 1);
+    }
+    return tree;
+}
+
 
 TEST(GCTest, TestMinor) {
     Generational gc{ 4700 };
@@ -195,3 +226,651 @@ TEST(GCTest, TestPromotionCrossGenRefGC) {
 
     gc.printState();
 }
+
+TEST(GCTest, TestLazySweep) {
+    constexpr size_t heapSize = NODE_SIZE * PAGE_CELLS * 2;
+    OldSpace space{ heapSize };
+    auto& roots = space.roots;
+    auto& ms = space.ms;
+
+    constexpr size_t cellCount = heapSize / NODE_SIZE;
+    for(size_t i = 0; i < cellCount; ++i) {
+        auto* emp = ms.allocate<Emp>();
+        if(i % 2 == 0) roots.push_back(emp);
+    }
+
+    ms.collect();
+    EXPECT_TRUE(ms.sweeping());
+    EXPECT_EQ(ms.freedBytes(), 0);
+
+    // 分配时只清除一页
+    ms.allocate<Emp>();
+    EXPECT_TRUE(ms.sweeping());
+    EXPECT_EQ(ms.freedBytes(), PAGE_CELLS / 2 * sizeof(Emp));
+
+    ms.sweep();
+    EXPECT_FALSE(ms.sweeping());
+    EXPECT_EQ(ms.freedBytes(), cellCount / 2 * sizeof(Emp));
+
+    // 存活对象的标记位已经被清除, 下一轮不会泄漏
+    roots.clear();
+    ms.collect();
+    while(!ms.sweepStep()) {}
+    EXPECT_EQ(ms.freedBytes(), (cellCount + 1) * sizeof(Emp));
+    EXPECT_GE(ms.sweepPause().count, 2);
+}
+
+TEST(GCTest, TestIncrementalMark) {
+    constexpr size_t heapSize = NODE_SIZE * 512;
+    OldSpace space{ heapSize };
+    auto& roots = space.roots;
+    auto& ms = space.ms;
+    ms.markBudget(std::chrono::microseconds{ 0 });
+
+    for(size_t i = 0; i < 200; ++i) {
+        auto* emp = ms.allocate<Emp>();
+        emp->dept = ms.allocate<Dept>();
+        emp->dept->id = i;
+        roots.push_back(emp);
+    }
+
+    auto* first = dynamic_cast<Emp*>(roots.front());
+    auto* last = dynamic_cast<Emp*>(roots.back());
+    Dept* moved = first->dept;
+
+    ms.startMarking();
+    EXPECT_TRUE(ms.marking());
+
+    size_t steps = 0;
+    while(!ms.markStep()) {
+        if(++steps == 1) {
+            // last 已经被扫描, first 还没有, 把 first 的 dept 转移给 last
+            ms.shade(moved);
+            last->dept = moved;
+            first->dept = nullptr;
+        }
+    }
+
+    EXPECT_GT(steps, 1);
+    EXPECT_FALSE(ms.marking());
+
+    ms.sweep();
+    EXPECT_EQ(ms.freedBytes(), 0);
+    EXPECT_EQ(moved->id, 0);
+
+    // last 原来的 dept 在这一轮是浮动垃圾, 下一轮回收
+    ms.collect();
+    ms.sweep();
+    EXPECT_EQ(ms.freedBytes(), sizeof(Dept));
+}
+
+// 耗时对比见 gc_bench --bench_workload=mark-scaling
+TEST(GCTest, TestParallelMark) {
+    constexpr size_t depth = 10;
+    constexpr size_t treeCount = 8;
+    constexpr size_t treeSize = ((1 << (depth + 1)) - 1) * sizeof(Tree);
+    constexpr size_t heapSize = NODE_SIZE * ((1 << (depth + 1)) * (treeCount + 1));
+    OldSpace space{ heapSize };
+    auto& roots = space.roots;
+    auto& ms = space.ms;
+
+    for(size_t i = 0; i < treeCount; ++i) {
+        roots.push_back(makeTree(ms, depth));
+    }
+
+    for(const size_t threads : { 1, 2, 4, 8 }) {
+        // 每一轮都有一棵树变成垃圾, 并行标记不能多标也不能漏标
+        makeTree(ms, depth);
+        const size_t freedBytes = ms.freedBytes();
+
+        ms.markThreads(threads);
+        ms.collect();
+        ms.sweep();
+
+        EXPECT_EQ(ms.freedBytes() - freedBytes, treeSize);
+    }
+}
+
+TEST(GCTest, TestConcurrentSweep) {
+    constexpr size_t heapSize = NODE_SIZE * PAGE_CELLS * 64;
+    OldSpace space{ heapSize };
+    auto& ms = space.ms;
+    ms.concurrentSweep(true);
+    EXPECT_TRUE(ms.concurrentSweep());
+
+    constexpr size_t cellCount = heapSize / NODE_SIZE;
+    for(int round = 0; round < 4; ++round) {
+        for(size_t i = 0; i < cellCount / 2; ++i) {
+            ms.allocate<Emp>();
+        }
+
+        ms.collect();
+
+        // 清除线程工作时, 分配线程也可以从已清除的页中取 cell
+        const size_t freedBefore = ms.freedBytes();
+        for(size_t i = 0; i < 16; ++i) {
+            ms.allocate<Emp>();
+        }
+
+        ms.sweep();
+        EXPECT_FALSE(ms.sweeping());
+        EXPECT_GE(ms.freedBytes(), freedBefore);
+        EXPECT_EQ(ms.usedCells(), 16);
+    }
+
+    ms.concurrentSweep(false);
+    EXPECT_FALSE(ms.concurrentSweep());
+}
+
+TEST(GCTest, TestCompaction) {
+    constexpr size_t heapSize = NODE_SIZE * PAGE_CELLS * 2;
+    OldSpace space{ heapSize };
+    auto& roots = space.roots;
+    auto& ms = space.ms;
+    ms.compactThreshold(0.4);
+
+    // 每 4 个 cell 中只有 emp 和它的 dept 存活, 空洞分散在整个老年代
+    constexpr size_t cellCount = heapSize / NODE_SIZE;
+    constexpr size_t groupCount = cellCount / 4;
+    for(size_t i = 0; i < groupCount; ++i) {
+        auto* emp = ms.allocate<Emp>();
+        emp->id = i;
+        ms.allocate<Dept>();
+        ms.allocate<Dept>();
+        auto* dept = ms.allocate<Dept>();
+        dept->id = i;
+        emp->dept = dept;
+        roots.push_back(emp);
+    }
+
+    // 增量标记结束时只清除, 不移动对象
+    auto* last = roots.back();
+    ms.startMarking();
+    while(!ms.markStep()) {}
+    EXPECT_TRUE(ms.compactPending());
+    EXPECT_EQ(ms.compactPause().count, 0);
+    EXPECT_EQ(roots.back(), last);
+
+    ms.collect();
+    EXPECT_FALSE(ms.compactPending());
+    EXPECT_FALSE(ms.sweeping());
+    EXPECT_EQ(ms.compactPause().count, 1);
+    EXPECT_DOUBLE_EQ(ms.fragmentation(), 0.0);
+    EXPECT_EQ(ms.usedCells(), groupCount * 2);
+    EXPECT_EQ(ms.liveBytes(), groupCount * (sizeof(Emp) + sizeof(Dept)));
+    EXPECT_EQ(ms.freedBytes(), groupCount * 2 * sizeof(Dept));
+
+    // 存活对象都被搬到了低地址, 引用也已经更新
+    const uintptr_t boundary = ms.start() + groupCount * 2 * NODE_SIZE;
+    for(size_t i = 0; i < groupCount; ++i) {
+        auto* emp = dynamic_cast<Emp*>(roots[i]);
+        ASSERT_NE(emp, nullptr);
+        EXPECT_LT(reinterpret_cast<uintptr_t>(emp), boundary);
+        EXPECT_LT(reinterpret_cast<uintptr_t>(emp->dept), boundary);
+        EXPECT_EQ(emp->id, i);
+        EXPECT_EQ(emp->dept->id, i);
+        EXPECT_EQ(emp->dept->name, "dept_object");
+    }
+
+    // 剩余的 cell 是连续的, 不需要再次回收
+    for(size_t i = 0; i < cellCount - groupCount * 2; ++i) {
+        ms.allocate<Dept>();
+    }
+    EXPECT_EQ(ms.usedCells(), cellCount);
+    EXPECT_EQ(ms.compactPause().count, 1);
+}
+
+TEST(GCTest, TestYoungToOldRef) {
+    Generational gc{ 2048 * 16 };
+    auto& roots = gc.allocateRoots();
+
+    for(int i = 0; i < 8; ++i) {
+        gc.allocateOldSpace<Dept>();
+    }
+
+    auto* dept = gc.allocateOldSpace<Dept>();
+    dept->id = 42;
+
+    // 老年代对象只被新生代对象引用
+    auto* emp = gc.allocateNewSpace<Emp>();
+    roots.push_back(emp);
+    gc.updatePtr(emp, &emp->dept, dept);
+
+    gc.collect();
+    gc.safepoint();
+
+    emp = dynamic_cast<Emp*>(roots[0]);
+    ASSERT_NE(emp, nullptr);
+    EXPECT_TRUE(gc.isYoung(emp));
+    ASSERT_EQ(emp->dept, dept);
+    EXPECT_EQ(emp->dept->id, 42);
+
+    // 整理后 dept 被搬到老年代开头, 新生代中的引用也要更新
+    gc.compact();
+
+    emp = dynamic_cast<Emp*>(roots[0]);
+    ASSERT_NE(emp, nullptr);
+    EXPECT_NE(emp->dept, dept);
+    EXPECT_EQ(emp->dept->id, 42);
+    EXPECT_EQ(emp->dept->name, "dept_object");
+}
+
+TEST(GCTest, TestCompactAtSafepoint) {
+    FLAGS_gc_compact_threshold = 0.4;
+    Generational gc{ 2048 * 64 };
+    FLAGS_gc_compact_threshold = 0.0;
+
+    // 每 4 个 cell 中只有一个存活, 占用超过 MARK_START_OCCUPANCY
+    auto& roots = gc.allocateRoots();
+    const size_t oldCells = gc.stats().oldCapacity / NODE_SIZE;
+    for(size_t i = 0; i < oldCells * 4 / 5; ++i) {
+        auto* dept = gc.allocateOldSpace<Dept>();
+        dept->id = i;
+        if(i % 4 == 3) roots.push_back(dept);
+    }
+    const std::vector<GCObject*> before{ roots.begin(), roots.end() };
+
+    // minor GC 中推进的增量标记不会移动老年代对象
+    do {
+        gc.minorGC();
+    } while(gc.marking());
+    EXPECT_EQ(gc.stats().compactPause.count, 0);
+    EXPECT_TRUE(std::ranges::equal(roots, before));
+
+    gc.safepoint();
+    EXPECT_EQ(gc.stats().compactPause.count, 1);
+    EXPECT_FALSE(std::ranges::equal(roots, before));
+    for(size_t i = 0; i < roots.size(); ++i) {
+        auto* dept = dynamic_cast<Dept*>(roots[i]);
+        ASSERT_NE(dept, nullptr);
+        EXPECT_EQ(dept->id, i * 4 + 3);
+    }
+}
+
+TEST(GCTest, TestMinorGCDuringMarking) {
+    Generational gc{ 64 * 1024 * 1024 };
+
+    // 老年代占用超过 MARK_START_OCCUPANCY, minor GC 后开始增量标记
+    auto& old = gc.allocateRoots();
+    const size_t oldCells = gc.stats().oldCapacity / NODE_SIZE;
+    while(old.size() < oldCells * 4 / 5) {
+        old.push_back(gc.allocateOldSpace<Tree>());
+    }
+
+    auto& roots = gc.allocateRoots();
+    for(size_t i = 0; i < 20000; ++i) {
+        auto* tree = gc.allocateNewSpace<Tree>();
+        gc.updatePtr(tree, &tree->right, dynamic_cast<Tree*>(old[i]));
+        roots.push_back(tree);
+    }
+
+    gc.minorGC();
+    ASSERT_TRUE(gc.marking());
+
+    // 标记还没有完成时再次移动新生代对象
+    gc.minorGC();
+    while(gc.marking()) {
+        gc.safepoint();
+    }
+    EXPECT_EQ(gc.stats().markCycles, 1);
+
+    for(size_t i = 0; i < roots.size(); ++i) {
+        auto* tree = dynamic_cast<Tree*>(roots[i]);
+        ASSERT_NE(tree, nullptr);
+        EXPECT_TRUE(gc.isYoung(tree));
+        ASSERT_EQ(tree->right, old[i]);
+    }
+}
+
+TEST(GCTest, TestHeapGrowth) {
+    constexpr size_t heapSize = NODE_SIZE * PAGE_CELLS * 2;
+    OldSpace space{ heapSize };
+    auto& roots = space.roots;
+    auto& ms = space.ms;
+    ms.growOccupancy(0.7);
+    ms.maxCells(PAGE_CELLS * 16);
+
+    // 所有对象都存活, 只能扩容
+    constexpr size_t cellCount = heapSize / NODE_SIZE;
+    for(size_t i = 0; i < cellCount * 3; ++i) {
+        roots.push_back(ms.allocate<Dept>());
+    }
+    EXPECT_EQ(ms.regionCount(), 3);
+    EXPECT_EQ(ms.cellCount(), cellCount * 4);
+
+    for(size_t i = 0; i < roots.size(); ++i) {
+        EXPECT_TRUE(ms.contains(roots[i]));
+    }
+
+    // 达到上限后不再扩容
+    EXPECT_EQ(ms.grow(cellCount * 4), cellCount * 4);
+    EXPECT_EQ(ms.grow(cellCount), 0);
+
+    // 整理后空出来的块被释放
+    roots.resize(cellCount / 4);
+    ms.compact();
+    EXPECT_EQ(ms.regionCount(), 1);
+    EXPECT_EQ(ms.cellCount(), cellCount);
+    EXPECT_EQ(ms.usedCells(), cellCount / 4);
+
+    for(size_t i = 0; i < cellCount - cellCount / 4; ++i) {
+        ms.allocate<Dept>();
+    }
+    EXPECT_EQ(ms.cellCount(), cellCount);
+}
+
+TEST(GCTest, TestAdaptiveNursery) {
+    Generational gc{ 64 * 1024 * 1024 };
+    auto& roots = gc.allocateRoots();
+    const size_t maxEden = gc.edenLimit();
+
+    // 对象全部死亡, eden 逐渐缩小
+    for(size_t i = 0; i < maxEden / sizeof(Dept) * 16; ++i) {
+        gc.allocateNewSpace<Dept>();
+    }
+    const size_t minEden = gc.edenLimit();
+    EXPECT_LT(minEden, maxEden);
+    EXPECT_GE(minEden, MIN_EDEN_SIZE);
+    EXPECT_LT(gc.survivalRate(), 0.1);
+
+    // 对象全部存活, eden 重新扩大
+    for(size_t i = 0; i < minEden / sizeof(Dept) * 8; ++i) {
+        roots.push_back(gc.allocateNewSpace<Dept>());
+    }
+    EXPECT_GT(gc.edenLimit(), minEden);
+    EXPECT_GT(gc.survivalRate(), 0.1);
+}
+
+TEST(GCTest, TestTlabThreads) {
+    Generational gc{ 64 * 1024 * 1024 };
+
+    constexpr size_t threadCount = 4;
+    constexpr size_t objectCount = 4096;
+    std::vector<std::vector<Dept*>> allocated(threadCount);
+
+    // eden 足够大, 不会触发 minor GC, 每个线程在自己的 TLAB 中分配
+    std::vector<std::thread> threads{};
+    for(size_t id = 0; id < threadCount; ++id) {
+        threads.emplace_back([&, id] {
+            for(size_t i = 0; i < objectCount; ++i) {
+                auto* dept = gc.allocateNewSpace<Dept>();
+                dept->id = id * objectCount + i;
+                allocated[id].push_back(dept);
+            }
+        });
+    }
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<Dept*> unique{};
+    for(size_t id = 0; id < threadCount; ++id) {
+        for(size_t i = 0; i < objectCount; ++i) {
+            Dept* dept = allocated[id][i];
+            EXPECT_TRUE(gc.isYoung(dept));
+            EXPECT_EQ(dept->id, id * objectCount + i);
+            unique.insert(dept);
+        }
+    }
+    EXPECT_EQ(unique.size(), threadCount * objectCount);
+}
+
+TEST(GCTest, TestPretenuredThreads) {
+    Generational gc{ 64 * 1024 * 1024 };
+
+    AllocationSite site{ "test::pretenuredThreads" };
+    site.tenured(true);
+
+    constexpr size_t threadCount = 4;
+    constexpr size_t objectCount = 4096;
+    std::vector<std::vector<Dept*>> allocated(threadCount);
+
+    // 多个线程同时通过预晋升的分配点在老年代分配
+    std::vector<std::thread> threads{};
+    for(size_t id = 0; id < threadCount; ++id) {
+        threads.emplace_back([&, id] {
+            for(size_t i = 0; i < objectCount; ++i) {
+                auto* dept = gc.allocate<Dept>(site);
+                dept->id = id * objectCount + i;
+                allocated[id].push_back(dept);
+            }
+        });
+    }
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<Dept*> unique{};
+    for(size_t id = 0; id < threadCount; ++id) {
+        for(size_t i = 0; i < objectCount; ++i) {
+            Dept* dept = allocated[id][i];
+            EXPECT_FALSE(gc.isYoung(dept));
+            EXPECT_EQ(dept->id, id * objectCount + i);
+            unique.insert(dept);
+        }
+    }
+    EXPECT_EQ(unique.size(), threadCount * objectCount);
+    EXPECT_EQ(gc.stats().pretenuredBytes, threadCount * objectCount * sizeof(Dept));
+}
+
+TEST(GCTest, TestStatsAndTrace) {
+    Generational gc{ 2048 * 16 };
+    gc.tracing(true);
+    auto& roots = gc.allocateRoots();
+
+    for(int j = 0; j < 8; j++) {
+        roots.push_back(gc.allocateNewSpace<Emp>());
+
+        for(int i = 0; i < 64; i++) {
+            gc.allocateNewSpace<Emp>();
+        }
+    }
+
+    roots.clear();
+    gc.collect();
+
+    const GCStats stats = gc.stats();
+    EXPECT_GT(stats.minorPause.count, 1);
+    EXPECT_GE(stats.minorPause.total, stats.minorPause.max);
+    EXPECT_EQ(stats.markCycles, 1);
+    EXPECT_GT(stats.promotedBytes, 0);
+    EXPECT_GT(stats.youngFreedBytes, 0);
+    EXPECT_EQ(stats.collectedBytes, stats.youngFreedBytes + stats.survivedBytes + stats.promotedBytes);
+    EXPECT_EQ(stats.oldLiveBytes, 0);
+    EXPECT_EQ(stats.rememberedSetSize, 0);
+
+    // 每次 minor GC 和每次老年代停顿都是一个事件
+    ASSERT_NE(gc.tracer(), nullptr);
+    EXPECT_EQ(
+        gc.tracer()->eventCount(),
+        stats.minorPause.count + stats.markPause.count + stats.sweepPause.count + stats.compactPause.count
+    );
+
+    std::stringstream trace{};
+    gc.tracer()->write(trace);
+    const std::string json = trace.str();
+    EXPECT_TRUE(json.starts_with(R"({"traceEvents":[)"));
+    EXPECT_NE(json.find(R"("name":"minor","cat":"gc","ph":"X")"), std::string::npos);
+    EXPECT_NE(json.find(R"("name":"mark")"), std::string::npos);
+    EXPECT_NE(json.find(R"("promotedBytes":)"), std::string::npos);
+}
+
+TEST(GCTest, TestPretenuring) {
+    Generational gc{ 2048 * 64 };
+    auto& roots = gc.allocateRoots();
+
+    AllocationSite longLived{ "test::longLived" };
+    AllocationSite shortLived{ "test::shortLived" };
+
+    // 一个分配点的对象全部存活, 另一个全部死亡
+    for(size_t i = 0; i < PRETENURE_MIN_ALLOCATIONS * 2; ++i) {
+        roots.push_back(gc.allocate<Dept>(longLived));
+        gc.allocate<Dept>(shortLived);
+    }
+    gc.minorGC();
+
+    EXPECT_TRUE(longLived.tenured());
+    EXPECT_FALSE(shortLived.tenured());
+
+    // 之后直接在老年代分配
+    const size_t pretenured = gc.stats().pretenuredBytes;
+    auto* dept = gc.allocate<Dept>(longLived);
+    EXPECT_FALSE(gc.isYoung(dept));
+    EXPECT_EQ(gc.stats().pretenuredBytes, pretenured + sizeof(Dept));
+
+    EXPECT_TRUE(gc.isYoung(gc.allocate<Dept>(shortLived)));
+}
+
+TEST(GCTest, TestPermSpace) {
+    auto permSpace = std::make_shared<PermSpace>();
+
+    Generational gc{ 2048 * 64, permSpace };
+    auto& roots = gc.allocateRoots();
+
+    auto* constant = gc.allocatePermSpace<Dept>();
+    constant->id = 42;
+    EXPECT_TRUE(constant->perm());
+    EXPECT_TRUE(permSpace->contains(constant));
+    EXPECT_FALSE(gc.isYoung(constant));
+
+    // 永久区之间可以互相引用
+    auto* node = gc.allocatePermSpace<Tree>();
+    node->left = gc.allocatePermSpace<Tree>();
+
+    auto* young = gc.allocateNewSpace<Emp>();
+    gc.updatePtr(young, &young->dept, constant);
+    auto* old = gc.allocateOldSpace<Emp>();
+    gc.updatePtr(old, &old->dept, constant);
+    roots.push_back(young);
+    roots.push_back(old);
+
+    gc.collect();
+    gc.compact();
+
+    // 永久区的对象不会被移动, 也不会被标记
+    auto* youngAfter = static_cast<Emp*>(roots[0]);
+    auto* oldAfter = static_cast<Emp*>(roots[1]);
+    EXPECT_EQ(youngAfter->dept, constant);
+    EXPECT_EQ(oldAfter->dept, constant);
+    EXPECT_EQ(constant->id, 42);
+    EXPECT_FALSE(constant->marked());
+    EXPECT_TRUE(permSpace->contains(node->left));
+
+    // freeze 之后可以被其他堆共享
+    permSpace->freeze();
+    EXPECT_TRUE(permSpace->frozen());
+
+    Generational other{ 2048 * 64, permSpace };
+    auto* emp = other.allocateNewSpace<Emp>();
+    other.updatePtr(emp, &emp->dept, constant);
+    other.allocateRoots().push_back(emp);
+    other.collect();
+
+    EXPECT_EQ(other.stats().permBytes, gc.stats().permBytes);
+    EXPECT_EQ(permSpace->objectCount(), 3);
+}
+
+class Handle final : public GCObject {
+public:
+    explicit Handle(size_t* released) : released(released) {
+    }
+
+    size_t* released;
+
+    void finalize() override {
+        ++*released;
+    }
+
+    constexpr size_t size() const noexcept override {
+        return sizeof(Handle);
+    }
+
+    GCObject* copyTo(uint8_t* to) override {
+        return new(to) Handle{ *this };
+    }
+};
+
+TEST(GCTest, TestWeakRefAndFinalizer) {
+    Generational gc{ 2048 * 64 };
+    auto& roots = gc.allocateRoots();
+
+    size_t released = 0;
+
+    // 新生代
+    roots.push_back(gc.allocateNewSpace<Dept>());
+    auto* live = gc.createWeakRef(roots[0]);
+    auto* dead = gc.createWeakRef(gc.allocateNewSpace<Dept>());
+    gc.registerFinalizer(gc.allocateNewSpace<Handle>(&released));
+
+    gc.minorGC();
+
+    EXPECT_EQ(live->get(), roots[0]);
+    EXPECT_TRUE(dead->cleared());
+
+    // 终结器只在安全点执行
+    EXPECT_EQ(released, 0);
+    EXPECT_EQ(gc.stats().pendingFinalizers, 1);
+    gc.safepoint();
+    EXPECT_EQ(released, 1);
+    EXPECT_EQ(gc.stats().pendingFinalizers, 0);
+
+    // 老年代
+    auto* oldDead = gc.createWeakRef(gc.allocateOldSpace<Dept>());
+    gc.registerFinalizer(gc.allocateOldSpace<Handle>(&released));
+    roots.push_back(gc.allocateOldSpace<Dept>());
+    auto* oldLive = gc.createWeakRef(roots[1]);
+
+    gc.collect();
+    EXPECT_TRUE(oldDead->cleared());
+    EXPECT_FALSE(oldLive->cleared());
+    EXPECT_EQ(gc.stats().pendingFinalizers, 1);
+
+    // 整理后弱引用指向新地址
+    gc.compact();
+    EXPECT_EQ(oldLive->get(), roots[1]);
+
+    EXPECT_EQ(gc.runFinalizers(), 1);
+    EXPECT_EQ(released, 2);
+
+    gc.collect();
+    EXPECT_EQ(released, 2);
+    EXPECT_EQ(gc.stats().finalizedObjects, 2);
+    EXPECT_EQ(gc.stats().clearedWeakRefs, 2);
+
+    gc.releaseWeakRef(live);
+    EXPECT_EQ(gc.stats().weakRefs, 3);
+}
+
+TEST(GCTest, TestTorture) {
+    FLAGS_gc_torture = true;
+
+    Generational gc{ 2048 * 64 };
+    auto& roots = gc.allocateRoots();
+
+    // 每次分配都会回收, 中间结果必须放在根集合中
+    roots.push_back(gc.allocateNewSpace<Tree>());
+    for(size_t i = 0; i < 64; ++i) {
+        auto* node = gc.allocateNewSpace<Tree>();
+        gc.updatePtr(node, &node->left, static_cast<Tree*>(roots[0]));
+        roots[0] = node;
+    }
+
+    auto* old = gc.allocateOldSpace<Emp>();
+    roots.push_back(old);
+    auto* dept = gc.allocateNewSpace<Dept>();
+    old = static_cast<Emp*>(roots[1]);
+    gc.updatePtr(old, &old->dept, dept);
+    dept->id = 7;
+
+    FLAGS_gc_torture = false;
+
+    size_t depth = 0;
+    for(auto* node = static_cast<Tree*>(roots[0]); node; node = node->left) ++depth;
+    EXPECT_EQ(depth, 65);
+
+    gc.collect();
+    EXPECT_EQ(static_cast<Emp*>(roots[1])->dept->id, 7);
+    EXPECT_GT(gc.stats().minorPause.count, 64);
+}
@@ -12,6 +12,8 @@
  *
  */
 
+#include <random>
+
 #include <gtest/gtest.h>
 
 #include "../src/vm/Interpreter.hpp"
@@ -20,6 +22,38 @@
 #include "../src/ast/AstFormatter.hpp"
 #include "../src/gen/BytecodeGen.hpp"
 #include "../src/common/SourceFile.hpp"
+#include "../src/common/UTF8.hpp"
+#include "../src/collections/FlatHashMap.hpp"
+#include "../src/types/TjsArray.hpp"
+#include "../src/types/TjsDictionary.hpp"
+#include "../src/types/TjsScriptObject.hpp"
+#include "../src/types/TjsString.hpp"
+#include "../src/core/math.hpp"
+#include "../src/core/octet.hpp"
+#include "../src/core/string.hpp"
+
+namespace {
+    // 编译好的脚本, chunk 引用源文件和语法树中的内容, 三者一起保存
+    struct Compiled {
+        Ciallang::Common::SourceFile sourceFile{};
+        Ciallang::Syntax::AstBuilder astBuilder{};
+        std::unique_ptr<Ciallang::Bytecode::Chunk> chunk{};
+    };
+
+    // 解析失败或者没有生成 chunk 时报告致命错误, 调用方用 ASSERT_NO_FATAL_FAILURE 包裹
+    void compile(Compiled& compiled, const std::string& source, const bool intrinsics = true) {
+        Ciallang::Common::Result r{};
+        compiled.sourceFile.load(r, source);
+        Ciallang::Syntax::Parser parser{ compiled.sourceFile, compiled.astBuilder };
+        auto* globalNode = parser.parse(r);
+        ASSERT_FALSE(r.isFailed());
+
+        Ciallang::Inter::BytecodeGen codeGen{ compiled.sourceFile };
+        codeGen.enableIntrinsics(intrinsics);
+        compiled.chunk = codeGen.parseAst(r, globalNode);
+        ASSERT_TRUE(compiled.chunk);
+    }
+}
 
 TEST(InterpreterTest, TestExecute) {
     Ciallang::Common::Result r{};
@@ -42,3 +76,896 @@ TEST(InterpreterTest, TestExecute) {
     interpreter.run(chunk.get());
     fmt::println("{}", interpreter.dumpRegisters());
 }
+
+TEST(InterpreterTest, TestShapeTransitions) {
+    using Ciallang::TjsScriptObject;
+    using Ciallang::TjsShape;
+    using Ciallang::TjsValue;
+
+    TjsScriptObject a{};
+    TjsScriptObject b{};
+    TjsScriptObject c{};
+
+    a.set("x", TjsValue{ 1LL });
+    a.set("y", TjsValue{ 2LL });
+    b.set("x", TjsValue{ 3LL });
+    b.set("y", TjsValue{ 4LL });
+    c.set("y", TjsValue{ 5LL });
+    c.set("x", TjsValue{ 6LL });
+
+    // 相同顺序添加相同属性的对象共享形状
+    EXPECT_EQ(a.shape(), b.shape());
+    EXPECT_NE(a.shape(), c.shape());
+    EXPECT_EQ(a.shape()->parent()->parent(), TjsShape::root());
+
+    EXPECT_EQ(a.find("x"), 0);
+    EXPECT_EQ(a.find("y"), 1);
+    EXPECT_EQ(c.find("x"), 1);
+    EXPECT_FALSE(a.find("z").has_value());
+
+    // 修改已有属性不会迁移
+    const auto* shape = a.shape();
+    a.set("x", TjsValue{ 7LL });
+    EXPECT_EQ(a.shape(), shape);
+    EXPECT_EQ(a.get("x")->asInteger(), 7);
+    EXPECT_EQ(b.get("y")->asInteger(), 4);
+}
+
+TEST(InterpreterTest, TestPropertyOpcodes) {
+    Compiled compiled{};
+    ASSERT_NO_FATAL_FAILURE(compile(compiled, R"(
+        obj.x = 1;
+        obj.y = obj.x + 2;
+        obj.x += 10;
+        other.x = obj.y;
+    )"));
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("obj", Ciallang::TjsValue{ Ciallang::TjsScriptObject{} });
+    interpreter.global("other", Ciallang::TjsValue{ Ciallang::TjsScriptObject{} });
+
+    const auto dump = interpreter.dumpInstruction(*compiled.chunk);
+    EXPECT_NE(dump.find("gpd"), std::string::npos);
+    EXPECT_NE(dump.find("spde"), std::string::npos);
+
+    interpreter.run(compiled.chunk.get());
+
+    const auto* obj = static_cast<Ciallang::TjsScriptObject*>(interpreter.global("obj").asObject());
+    const auto* other = static_cast<Ciallang::TjsScriptObject*>(interpreter.global("other").asObject());
+    EXPECT_EQ(obj->get("x")->asInteger(), 11);
+    EXPECT_EQ(obj->get("y")->asInteger(), 3);
+    EXPECT_EQ(other->get("x")->asInteger(), 3);
+}
+
+TEST(InterpreterTest, TestArrayElementKinds) {
+    using Ciallang::TjsArray;
+    using Ciallang::TjsElementKind;
+    using Ciallang::TjsInteger;
+    using Ciallang::TjsReal;
+    using Ciallang::TjsValue;
+
+    TjsArray integers{};
+    EXPECT_EQ(integers.kind(), TjsElementKind::Empty);
+    for(TjsInteger i = 0; i < 4; ++i) {
+        integers.push(TjsValue{ i * 10 });
+    }
+    EXPECT_EQ(integers.kind(), TjsElementKind::PackedInteger);
+    EXPECT_EQ(integers.integers().size(), 4);
+    EXPECT_EQ(integers.get(-1).asInteger(), 30);
+    EXPECT_TRUE(integers.get(4).isVoid());
+
+    // 整数和实数混合后不能再紧凑存放, 读出来的类型保持不变
+    integers.set(1, TjsValue{ TjsReal{ 1.5 } });
+    EXPECT_EQ(integers.kind(), TjsElementKind::Generic);
+    EXPECT_TRUE(integers.get(0).isInteger());
+    EXPECT_EQ(integers.get(1).asReal(), 1.5);
+    EXPECT_TRUE(integers.integers().empty());
+
+    TjsArray reals{};
+    reals.push(TjsValue{ TjsReal{ 0.5 } });
+    reals.set(-1, TjsValue{ TjsReal{ 2.5 } });
+    EXPECT_EQ(reals.kind(), TjsElementKind::PackedReal);
+    EXPECT_EQ(reals.reals()[0], 2.5);
+
+    // 越界写入留下 void 空洞
+    reals.set(3, TjsValue{ TjsReal{ 3.5 } });
+    EXPECT_EQ(reals.kind(), TjsElementKind::Generic);
+    EXPECT_EQ(reals.size(), 4);
+    EXPECT_TRUE(reals.get(1).isVoid());
+
+    EXPECT_THROW(reals.set(-5, TjsValue{}), std::out_of_range);
+
+    // 离末尾太远的写入直接报错, 数组保持不变
+    EXPECT_THROW(reals.set(1000000000000, TjsValue{ TjsReal{ 1.0 } }), std::out_of_range);
+    EXPECT_THROW(reals.set(std::numeric_limits<TjsInteger>::max(), TjsValue{}), std::out_of_range);
+    EXPECT_EQ(reals.size(), 4);
+
+    TjsArray sparse{};
+    sparse.set(TjsArray::MAX_WRITE_GAP, TjsValue{ TjsInteger{ 1 } });
+    EXPECT_EQ(sparse.size(), TjsArray::MAX_WRITE_GAP + 1);
+    EXPECT_THROW(sparse.set(TjsArray::MAX_WRITE_GAP * 3 + 2, TjsValue{}), std::out_of_range);
+}
+
+TEST(InterpreterTest, TestArrayIndexOpcodes) {
+    Compiled compiled{};
+    ASSERT_NO_FATAL_FAILURE(compile(compiled, R"(
+        arr[0] = 1;
+        arr[1] = arr[0] + 2;
+        arr[1] += 10;
+        out.x = arr[1];
+        out["y"] = arr[0];
+    )"));
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("arr", Ciallang::TjsValue{ Ciallang::TjsArray{} });
+    interpreter.global("out", Ciallang::TjsValue{ Ciallang::TjsScriptObject{} });
+
+    const auto dump = interpreter.dumpInstruction(*compiled.chunk);
+    EXPECT_NE(dump.find("gpi"), std::string::npos);
+    EXPECT_NE(dump.find("spie"), std::string::npos);
+
+    interpreter.run(compiled.chunk.get());
+
+    const auto* arr = static_cast<Ciallang::TjsArray*>(interpreter.global("arr").asObject());
+    const auto* out = static_cast<Ciallang::TjsScriptObject*>(interpreter.global("out").asObject());
+    EXPECT_EQ(arr->kind(), Ciallang::TjsElementKind::PackedInteger);
+    EXPECT_EQ(arr->size(), 2);
+    EXPECT_EQ(arr->get(1).asInteger(), 13);
+    EXPECT_EQ(out->get("x")->asInteger(), 13);
+    EXPECT_EQ(out->get("y")->asInteger(), 1);
+}
+
+TEST(InterpreterTest, TestFlatHashMap) {
+    Ciallang::Collections::FlatHashMap<int, std::string> map{};
+    EXPECT_EQ(map.find(1), nullptr);
+
+    for(int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(map.tryEmplace(i, std::to_string(i)).second);
+    }
+    EXPECT_FALSE(map.tryEmplace(7, "x").second);
+    EXPECT_EQ(map.size(), 1000);
+    EXPECT_LE(map.size(), map.capacity() - map.capacity() / 8);
+
+    // 删除后留下的墓碑不能打断其他键的探测
+    for(int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(map.erase(i));
+    }
+    EXPECT_FALSE(map.erase(0));
+    for(int i = 0; i < 1000; ++i) {
+        const auto* value = map.find(i);
+        if(i % 2 == 0) {
+            EXPECT_EQ(value, nullptr);
+        } else {
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(*value, std::to_string(i));
+        }
+    }
+
+    // 反复插入删除不会让表无限增长
+    const auto capacity = map.capacity();
+    for(int i = 0; i < 10000; ++i) {
+        map.insertOrAssign(-1 - i, "tmp");
+        map.erase(-1 - i);
+    }
+    EXPECT_EQ(map.capacity(), capacity);
+
+    const auto copy = map;
+    map.insertOrAssign(1, "one");
+    EXPECT_EQ(*copy.find(1), "1");
+    EXPECT_EQ(*map.find(1), "one");
+    EXPECT_EQ(copy.size(), 500);
+}
+
+TEST(InterpreterTest, TestDictionary) {
+    using Ciallang::TjsInteger;
+    using Ciallang::TjsScriptObject;
+    using Ciallang::TjsStringTable;
+    using Ciallang::TjsValue;
+
+    // 相同内容只驻留一份
+    const std::string name{ "interned" };
+    EXPECT_EQ(TjsStringTable::intern(name), TjsStringTable::intern("interned"));
+    EXPECT_NE(TjsStringTable::intern(name), TjsStringTable::intern("other"));
+
+    Ciallang::TjsDictionary dictionary{};
+    dictionary.set("a", TjsValue{ TjsInteger{ 1 } });
+    dictionary.set(TjsStringTable::intern("a"), TjsValue{ TjsInteger{ 2 } });
+    EXPECT_EQ(dictionary.size(), 1);
+    EXPECT_EQ(dictionary.get("a")->asInteger(), 2);
+    EXPECT_EQ(dictionary.get("b"), nullptr);
+
+    // 属性太多的对象转为字典模式, 已有的属性保留
+    TjsScriptObject object{};
+    for(TjsInteger i = 0; i <= TjsScriptObject::MAX_FAST_PROPERTIES; ++i) {
+        object.set(fmt::format("p{}", i), TjsValue{ i });
+    }
+    ASSERT_NE(object.dictionary(), nullptr);
+    EXPECT_EQ(object.shape(), Ciallang::TjsShape::dictionary());
+    EXPECT_EQ(object.dictionary()->size(), TjsScriptObject::MAX_FAST_PROPERTIES + 1);
+    EXPECT_EQ(object.get("p0")->asInteger(), 0);
+    EXPECT_EQ(object.get("p64")->asInteger(), 64);
+
+    Ciallang::Bytecode::Chunk chunk{};
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.pushCallFrame(interpreter.createCallFrame(&chunk));
+    interpreter.global("obj", TjsValue{ object });
+    EXPECT_THROW(interpreter.global("missing"), std::out_of_range);
+
+    using namespace Ciallang::Bytecode;
+    const Op::GGlobal gglobal{ TjsStringTable::intern("obj"), Register{ 0 } };
+    const Op::GPD gpd{ Register{ 1 }, Register{ 0 }, TjsStringTable::intern("p3") };
+    const Op::SPD spd{ Register{ 0 }, TjsStringTable::intern("q"), Register{ 1 }, true };
+    gglobal.execute(interpreter);
+    gpd.execute(interpreter);
+    spd.execute(interpreter);
+    EXPECT_EQ(interpreter.reg(Register{ 1 }).asInteger(), 3);
+
+    const auto* global = static_cast<TjsScriptObject*>(interpreter.global("obj").asObject());
+    EXPECT_EQ(global->get("q")->asInteger(), 3);
+
+    // 按运行时字符串读取和修改不存在的成员不会驻留新的字符串
+    const auto interned = TjsStringTable::size();
+    EXPECT_FALSE(TjsStringTable::find("never_interned_0"));
+    EXPECT_EQ(TjsStringTable::find("q"), TjsStringTable::intern("q"));
+
+    const Op::GPI gpi{ Register{ 3 }, Register{ 0 }, Register{ 2 } };
+    const Op::SPI spi{ Register{ 0 }, Register{ 2 }, Register{ 1 }, false };
+    const Op::SPI spie{ Register{ 0 }, Register{ 2 }, Register{ 1 }, true };
+    for(int i = 0; i < 16; ++i) {
+        interpreter.reg(Register{ 2 }, TjsValue{ fmt::format("never_interned_{}", i) });
+        gpi.execute(interpreter);
+        EXPECT_TRUE(interpreter.reg(Register{ 3 }).isVoid());
+        EXPECT_THROW(spi.execute(interpreter), std::logic_error);
+        EXPECT_EQ(global->get(interpreter.reg(Register{ 2 }).asString()), nullptr);
+    }
+    EXPECT_THROW(interpreter.global("never_interned_global"), std::out_of_range);
+    EXPECT_EQ(dictionary.get("never_interned_key"), nullptr);
+    EXPECT_EQ(TjsStringTable::size(), interned);
+
+    // spie 添加成员时才驻留
+    spie.execute(interpreter);
+    EXPECT_EQ(TjsStringTable::size(), interned + 1);
+    EXPECT_EQ(global->get("never_interned_15")->asInteger(), 3);
+}
+
+TEST(InterpreterTest, TestInternedIdentifiers) {
+    using Ciallang::TjsStringTable;
+
+    Compiled compiled{};
+    ASSERT_NO_FATAL_FAILURE(compile(compiled, R"(
+        var total = 1;
+        total += 2;
+        obj.total = total;
+    )"));
+
+    // 词法分析时已经驻留, 再次驻留不会增加新的字符串
+    const auto interned = TjsStringTable::size();
+    const auto total = TjsStringTable::intern("total");
+    EXPECT_EQ(TjsStringTable::size(), interned);
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("obj", Ciallang::TjsValue{ Ciallang::TjsScriptObject{} });
+    interpreter.run(compiled.chunk.get());
+
+    // 复合赋值会生成两次同一个标识符节点, 名字不能在第一次生成时被移走
+    EXPECT_EQ(interpreter.global(total).asInteger(), 3);
+    const auto* obj = static_cast<Ciallang::TjsScriptObject*>(interpreter.global("obj").asObject());
+    EXPECT_EQ(obj->get(total)->asInteger(), 3);
+}
+
+TEST(InterpreterTest, TestStringRope) {
+    using Ciallang::TjsString;
+    using Ciallang::TjsValue;
+
+    // 短字符串直接拼接成平坦字符串
+    const auto flat = TjsValue{ std::string(20, 'a') } + TjsValue{ Ciallang::TjsInteger{ 1 } };
+    EXPECT_TRUE(flat.asTjsString()->flat());
+    EXPECT_EQ(flat.asString(), std::string(20, 'a') + "1");
+
+    // 循环拼接只创建 rope 节点, 第一次读取内容时才展开
+    const std::string piece(TjsString::ROPE_MIN_LENGTH, 'x');
+    TjsValue text{ piece };
+    for(int i = 0; i < 100000; ++i) {
+        text = text + TjsValue{ piece };
+    }
+    EXPECT_EQ(text.asTjsString()->size(), piece.size() * 100001);
+    EXPECT_FALSE(text.asTjsString()->flat());
+    EXPECT_EQ(text.asTjsString()->depth(), 100000);
+
+    // 拷贝共享同一个字符串
+    const TjsValue copy{ text };
+    EXPECT_EQ(copy.asTjsString(), text.asTjsString());
+
+    Ciallang::TjsStringBuilder builder{};
+    builder.append(text);
+    builder.append(TjsValue{ Ciallang::TjsReal{ 0.5 } });
+    EXPECT_FALSE(text.asTjsString()->flat());
+    EXPECT_EQ(builder.size(), text.asTjsString()->size() + 3);
+
+    EXPECT_EQ(text.asString().size(), piece.size() * 100001);
+    EXPECT_TRUE(copy.asTjsString()->flat());
+    EXPECT_EQ(text.asString().find_first_not_of('x'), std::string_view::npos);
+
+    Compiled compiled{};
+    ASSERT_NO_FATAL_FAILURE(compile(compiled, R"(
+        var s = "log:";
+        var i = 0;
+        while(i < 100) {
+            s += i;
+            i += 1;
+        }
+        var sb = StringBuilder();
+        sbAppend(sb, s);
+        sbAppend(sb, "!");
+        var out = sbToString(sb);
+    )"));
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("StringBuilder", TjsValue{ Ciallang::Core::S_StringBuilderFunction });
+    interpreter.global("sbAppend", TjsValue{ Ciallang::Core::S_StringBuilderAppendFunction });
+    interpreter.global("sbToString", TjsValue{ Ciallang::Core::S_StringBuilderToStringFunction });
+    interpreter.run(compiled.chunk.get());
+
+    std::string expected{ "log:" };
+    for(int i = 0; i < 100; ++i) expected += std::to_string(i);
+    EXPECT_EQ(interpreter.global("s").asString(), expected);
+    EXPECT_EQ(interpreter.global("out").asString(), expected + "!");
+}
+
+TEST(InterpreterTest, TestSmallString) {
+    using Ciallang::TjsValue;
+
+    static_assert(sizeof(TjsValue) == 16);
+
+    // 短字符串存放在值里面, 不分配 TjsString
+    const TjsValue key{ std::string{ "position" } };
+    EXPECT_TRUE(key.isSmallString());
+    EXPECT_EQ(key.asTjsString(), nullptr);
+    EXPECT_EQ(key.asString(), "position");
+
+    TjsValue copy{ key };
+    EXPECT_EQ(copy, key);
+    EXPECT_NE(copy.asString().data(), key.asString().data());
+
+    const TjsValue moved{ std::move(copy) };
+    EXPECT_TRUE(copy.isVoid());
+    EXPECT_EQ(moved.asString(), "position");
+
+    // 拼接结果不超过容量时仍然是短字符串
+    const auto joined = key + TjsValue{ Ciallang::TjsInteger{ 123456 } };
+    EXPECT_TRUE(joined.isSmallString());
+    EXPECT_EQ(joined.asString(), "position123456");
+
+    const auto longer = joined + TjsValue{ std::string{ "!" } };
+    EXPECT_FALSE(longer.isSmallString());
+    EXPECT_EQ(longer.asString(), "position123456!");
+    EXPECT_LT(key, longer);
+
+    const TjsValue empty{ std::string{} };
+    EXPECT_TRUE(empty.isSmallString());
+    EXPECT_TRUE(empty.asString().empty());
+}
+
+TEST(InterpreterTest, TestOctetSlice) {
+    using Ciallang::TjsOctet;
+    using Ciallang::TjsValue;
+
+    std::vector<uint8_t> bytes(256);
+    for(size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<uint8_t>(i);
+    const TjsValue whole{ TjsOctet::make(std::move(bytes)) };
+    auto* octet = whole.asOctet();
+
+    // 切片的切片仍然指向原来的缓冲区
+    const TjsValue slice{ TjsOctet::slice(octet, 100, 50) };
+    const TjsValue inner{ TjsOctet::slice(slice.asOctet(), 10, 1000) };
+    EXPECT_EQ(slice.asOctet()->data(), octet->data() + 100);
+    EXPECT_EQ(inner.asOctet()->data(), octet->data() + 110);
+    EXPECT_EQ(inner.asOctet()->size(), 40);
+    EXPECT_THROW((void) TjsOctet::slice(octet, 257), std::out_of_range);
+
+    // 拷贝值只增加引用计数
+    const TjsValue copy{ inner };
+    EXPECT_EQ(copy.asOctet(), inner.asOctet());
+    EXPECT_TRUE(copy.isOctet());
+    EXPECT_FALSE(copy.isString());
+
+    // 跨过 16 字节块边界的查找
+    const std::vector<uint8_t> needle{ 30, 31, 32, 33 };
+    EXPECT_EQ(octet->find(needle), 30);
+    EXPECT_EQ(octet->find(needle, 31), TjsOctet::npos);
+    EXPECT_EQ(inner.asOctet()->find(std::vector<uint8_t>{ 149 }), 39);
+    EXPECT_EQ(inner.asOctet()->find(std::vector<uint8_t>{ 150 }), TjsOctet::npos);
+
+    std::string hex{};
+    for(size_t i = 110; i < 150; ++i) hex += fmt::format("{:02x}", i);
+    EXPECT_EQ(inner.asOctet()->toHex(), hex);
+
+    const std::pair<std::string, std::string> vectors[]{
+            { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+            { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" }
+    };
+    for(const auto& [plain, encoded] : vectors) {
+        const TjsValue value{ TjsOctet::make({ plain.begin(), plain.end() }) };
+        EXPECT_EQ(value.asOctet()->toBase64(), encoded);
+    }
+
+    // 覆盖整块 12 字节和尾部的所有长度, 以及全部 64 个字母
+    static constexpr char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::vector<uint8_t> sample(256);
+    for(size_t i = 0; i < sample.size(); ++i) sample[i] = static_cast<uint8_t>(i * 7 + 3);
+    for(size_t length = 0; length < 64; ++length) {
+        std::string expected{};
+        for(size_t i = 0; i < length; i += 3) {
+            const auto rest = std::min<size_t>(length - i, 3);
+            uint32_t bits = 0;
+            for(size_t k = 0; k < 3; ++k) bits = bits << 8 | (k < rest ? sample[i + k] : 0);
+            for(size_t k = 0; k < 4; ++k)
+                expected += k <= rest ? alphabet[bits >> (18 - 6 * k) & 0x3f] : '=';
+        }
+        const TjsValue value{ TjsOctet::make({ sample.begin(), sample.begin() + length }) };
+        EXPECT_EQ(value.asOctet()->toBase64(), expected) << length;
+    }
+    const TjsValue all{ TjsOctet::make(std::vector{ sample }) };
+    for(const auto c : std::string_view{ alphabet })
+        EXPECT_NE(all.asOctet()->toBase64().find(c), std::string::npos) << c;
+
+    // 拼接和比较按内容进行
+    const auto joined = slice + TjsValue{ TjsOctet::slice(octet, 150, 10) };
+    EXPECT_EQ(joined, TjsValue{ TjsOctet::slice(octet, 100, 60) });
+    EXPECT_LT(slice, joined);
+    EXPECT_EQ(fmt::format("{}", TjsValue{ TjsOctet::slice(octet, 10, 2) }), "<% 0a 0b %>");
+
+    Compiled compiled{};
+    ASSERT_NO_FATAL_FAILURE(compile(compiled, R"(
+        var packet = <% 01 02 03 04 05 %>;
+        var body = octetSlice(packet, 1, 3);
+        var hex = octetToHex(body);
+        var at = octetFind(packet, <% 04 05 %>);
+    )"));
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("octetSlice", TjsValue{ Ciallang::Core::S_OctetSliceFunction });
+    interpreter.global("octetToHex", TjsValue{ Ciallang::Core::S_OctetToHexFunction });
+    interpreter.global("octetFind", TjsValue{ Ciallang::Core::S_OctetFindFunction });
+    interpreter.run(compiled.chunk.get());
+
+    EXPECT_EQ(interpreter.global("hex").asString(), "020304");
+    EXPECT_EQ(interpreter.global("at").asInteger(), 3);
+}
+
+TEST(InterpreterTest, TestUtf8Validate) {
+    using namespace Ciallang::Common;
+
+    const auto valid = [](const std::string& text) {
+        const auto simd = utf8Validate(text.data(), text.size());
+        EXPECT_EQ(simd, utf8ValidateScalar(text.data(), text.size())) << text;
+        return simd;
+    };
+
+    EXPECT_TRUE(valid(""));
+    EXPECT_TRUE(valid("ciallo"));
+    EXPECT_TRUE(valid("h\xc3\xa9llo \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x98\x80"));
+    EXPECT_FALSE(valid("\xc0\x80"));          // 过长的 2 字节编码
+    EXPECT_FALSE(valid("\xe0\x80\x80"));      // 过长的 3 字节编码
+    EXPECT_FALSE(valid("\xed\xa0\x80"));      // 代理项
+    EXPECT_FALSE(valid("\xf4\x90\x80\x80"));  // 超过 U+10FFFF
+    EXPECT_FALSE(valid("\xf5\x80\x80\x80"));
+    EXPECT_FALSE(valid("\x80"));
+    EXPECT_FALSE(valid("abc\xe4\xb8"));       // 末尾被截断
+
+    // 多字节字符跨过 16 和 32 字节块的边界
+    for(size_t pad = 0; pad < 40; ++pad) {
+        const std::string prefix(pad, 'a');
+        EXPECT_TRUE(valid(prefix + "\xf0\x9f\x98\x80" + prefix));
+        EXPECT_FALSE(valid(prefix + "\xf0\x9f\x98" + prefix));
+        EXPECT_FALSE(valid(prefix + "\xf0\x9f\x98"));
+    }
+
+    // 随机拼接合法字符和随机字节, 与逐字节的实现对照
+    const std::string pieces[]{ "a", "~", "\xc3\xa9", "\xe4\xb8\xad", "\xef\xbb\xbf", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf" };
+    std::mt19937 random{ 42 };
+    for(int round = 0; round < 2000; ++round) {
+        std::string text{};
+        std::vector<size_t> offsets{};
+        const auto count = random() % 80;
+        for(size_t i = 0; i < count; ++i) {
+            offsets.push_back(text.size());
+            text += pieces[random() % std::size(pieces)];
+        }
+
+        if(round % 2 == 0) {
+            ASSERT_TRUE(valid(text));
+            ASSERT_EQ(utf8Count(text.data(), text.size()), count);
+            ASSERT_EQ(utf8CountScalar(text.data(), text.size()), count);
+            ASSERT_EQ(utf8Strlen(text), static_cast<int64_t>(count));
+            for(size_t i = 0; i < count; ++i) {
+                ASSERT_EQ(utf8Offset(text.data(), text.size(), i), offsets[i]);
+            }
+            ASSERT_EQ(utf8Offset(text.data(), text.size(), count), text.size());
+        } else if(!text.empty()) {
+            text[random() % text.size()] = static_cast<char>(random());
+            valid(text);
+        }
+    }
+
+    // 合法的源文件整块建立行表, 列数与逐字符解码一致
+    Result r{};
+    SourceFile sourceFile{};
+    sourceFile.load(r, "\xef\xbb\xbf" "ab\r\n\xe4\xb8\xad\xe6\x96\x87x\n");
+    ASSERT_FALSE(r.isFailed());
+    ASSERT_EQ(sourceFile.numberOfLines(), 3);
+    EXPECT_EQ(sourceFile.lineByNumber(0)->columns, 2);
+    EXPECT_EQ(sourceFile.lineByNumber(1)->columns, 3);
+    EXPECT_EQ(sourceFile.lineByNumber(1)->begin, 7);
+    EXPECT_EQ(sourceFile.lineByNumber(2)->columns, 0);
+
+    sourceFile.load(r, "ok\n\xc0\x80");
+    EXPECT_TRUE(r.isFailed());
+}
+
+TEST(InterpreterTest, TestStringFunctions) {
+    using Ciallang::TjsString;
+    using Ciallang::TjsValue;
+    using namespace Ciallang::Core;
+
+    // 长子串是切片, 切片的切片仍然指向原来的缓冲区
+    auto* base = TjsString::make(std::string(100, 'x') + "tail");
+    auto* slice = TjsString::substring(base, 10, 94);
+    auto* inner = TjsString::substring(slice, 5, 1000);
+    EXPECT_EQ(slice->view().data(), base->view().data() + 10);
+    EXPECT_EQ(inner->view().data(), base->view().data() + 15);
+    EXPECT_EQ(inner->view(), std::string(85, 'x') + "tail");
+    EXPECT_EQ(TjsString::substring(base, 0, 1000), base);
+    EXPECT_THROW((void) TjsString::substring(base, 105, 1), std::out_of_range);
+    TjsString::release(base);
+    TjsString::release(base);
+    TjsString::release(slice);
+
+    // 切片参与拼接时按片段读取
+    const TjsValue joined = TjsValue{ inner } + TjsValue{ std::string(40, 'y') };
+    EXPECT_EQ(joined.asString(), std::string(85, 'x') + "tail" + std::string(40, 'y'));
+
+    Compiled compiled{};
+    ASSERT_NO_FATAL_FAILURE(compile(compiled, R"(
+        var s = "  Hello, 世界! hello again  ";
+        var t = strTrim(s);
+        var n = strLength(t);
+        var at = strIndexOf(t, "世界");
+        var missing = strIndexOf(t, "bye");
+        var sub = strSubstring(t, at, 2);
+        var parts = strSplit("a,b,,c", ",");
+        var chars = strSplit("世界!", "");
+        var replaced = strReplace(t, "ello", "i");
+        var up = strToUpper("abc-XYZ-é");
+        var low = strToLower("ABC-xyz");
+    )"));
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("strLength", TjsValue{ S_StringLengthFunction });
+    interpreter.global("strIndexOf", TjsValue{ S_StringIndexOfFunction });
+    interpreter.global("strSubstring", TjsValue{ S_StringSubstringFunction });
+    interpreter.global("strSplit", TjsValue{ S_StringSplitFunction });
+    interpreter.global("strReplace", TjsValue{ S_StringReplaceFunction });
+    interpreter.global("strTrim", TjsValue{ S_StringTrimFunction });
+    interpreter.global("strToUpper", TjsValue{ S_StringToUpperFunction });
+    interpreter.global("strToLower", TjsValue{ S_StringToLowerFunction });
+    interpreter.run(compiled.chunk.get());
+
+    EXPECT_EQ(interpreter.global("t").asString(), "Hello, 世界! hello again");
+    EXPECT_EQ(interpreter.global("n").asInteger(), 22);
+    EXPECT_EQ(interpreter.global("at").asInteger(), 7);
+    EXPECT_EQ(interpreter.global("missing").asInteger(), -1);
+    EXPECT_EQ(interpreter.global("sub").asString(), "世界");
+    EXPECT_EQ(interpreter.global("replaced").asString(), "Hi, 世界! hi again");
+    EXPECT_EQ(interpreter.global("up").asString().substr(0, 8), "ABC-XYZ-");
+    EXPECT_EQ(interpreter.global("low").asString(), "abc-xyz");
+
+    const auto* parts = dynamic_cast<Ciallang::TjsArray*>(interpreter.global("parts").asObject());
+    ASSERT_NE(parts, nullptr);
+    ASSERT_EQ(parts->size(), 4);
+    EXPECT_EQ(parts->get(1).asString(), "b");
+    EXPECT_EQ(parts->get(2).asString(), "");
+    EXPECT_EQ(parts->get(3).asString(), "c");
+
+    const auto* chars = dynamic_cast<Ciallang::TjsArray*>(interpreter.global("chars").asObject());
+    ASSERT_NE(chars, nullptr);
+    ASSERT_EQ(chars->size(), 3);
+    EXPECT_EQ(chars->get(1).asString(), "界");
+}
+
+TEST(InterpreterTest, TestNativeCall) {
+    using Ciallang::TjsInteger;
+    using Ciallang::TjsNativeFunction;
+    using Ciallang::TjsValue;
+    using namespace Ciallang::Core;
+
+    // 参数是调用方连续寄存器的视图, 个数可以多于 arity, context 是注册时绑定的指针
+    size_t calls = 0;
+    const TjsNativeFunction count{
+        [](Ciallang::Bytecode::Interpreter&, const std::span<const TjsValue> values, TjsValue* ret, void* context) {
+            ++*static_cast<size_t*>(context);
+            *ret = TjsValue{ static_cast<TjsInteger>(values.size()) };
+        },
+        0, "count", &calls
+    };
+
+    Compiled compiled{};
+    ASSERT_NO_FATAL_FAILURE(compile(compiled, R"(
+        var s = "abcdef";
+        var n = 3;
+        var e = strSubstring(s, n + 1, n - 2);
+        var yz = strSubstring(strTrim("  xyz  "), 1, strLength("ab"));
+        function at(i) {
+            var next = i + 1;
+            return strSubstring(s, next, 1);
+        }
+        var c = at(1);
+        var k = count(n, e, n * 2);
+        var none = count();
+    )"));
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    interpreter.global("strLength", TjsValue{ S_StringLengthFunction });
+    interpreter.global("strSubstring", TjsValue{ S_StringSubstringFunction });
+    interpreter.global("strTrim", TjsValue{ S_StringTrimFunction });
+    interpreter.global("count", TjsValue{ count });
+    interpreter.run(compiled.chunk.get());
+
+    EXPECT_EQ(interpreter.global("e").asString(), "e");
+    EXPECT_EQ(interpreter.global("yz").asString(), "yz");
+    EXPECT_EQ(interpreter.global("c").asString(), "c");
+    EXPECT_EQ(interpreter.global("k").asInteger(), 3);
+    EXPECT_EQ(interpreter.global("none").asInteger(), 0);
+    EXPECT_EQ(calls, 2);
+
+    // 参数少于 arity 时报错
+    Compiled bad{};
+    ASSERT_NO_FATAL_FAILURE(compile(bad, R"(var bad = strSubstring("abc");)"));
+
+    Ciallang::Bytecode::Interpreter badInterpreter{};
+    badInterpreter.global("strSubstring", TjsValue{ S_StringSubstringFunction });
+    EXPECT_THROW(badInterpreter.run(bad.chunk.get()), std::logic_error);
+}
+
+namespace {
+    Ciallang::TjsReal scale(const Ciallang::TjsReal value, const size_t times, const bool negate) {
+        return (negate ? -value : value) * static_cast<Ciallang::TjsReal>(times);
+    }
+
+    bool isEmpty(const std::string_view view) {
+        return view.empty();
+    }
+}
+
+TEST(InterpreterTest, TestNativeBinding) {
+    using Ciallang::TjsInteger;
+    using Ciallang::TjsReal;
+    using Ciallang::TjsValue;
+    using namespace Ciallang::Core;
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    auto call = [&](const Ciallang::TjsNativeFunction& function, std::vector<TjsValue> arguments) {
+        TjsValue ret{};
+        function.call(interpreter, arguments, &ret);
+        return ret;
+    };
+
+    // 形参个数即 arity, 整数可以当作实数, 布尔值装箱为 0 和 1
+    const auto scaleFunction = bindNative<&scale>("scale");
+    const auto isEmptyFunction = bindNative<&isEmpty>("isEmpty");
+    EXPECT_EQ(scaleFunction.arity(), 3);
+    EXPECT_EQ(scaleFunction.name(), "scale");
+
+    std::vector<TjsValue> arguments{};
+    arguments.emplace_back(TjsInteger{ 3 });
+    arguments.emplace_back(TjsInteger{ 2 });
+    arguments.emplace_back(TjsInteger{ 1 });
+    EXPECT_EQ(call(scaleFunction, std::move(arguments)).asReal(), -6.0);
+
+    arguments.clear();
+    arguments.emplace_back(std::string{});
+    EXPECT_EQ(call(isEmptyFunction, std::move(arguments)).asInteger(), 1);
+
+    // 类型不符和负数下标都报错
+    arguments.clear();
+    arguments.emplace_back(std::string{ "1.5" });
+    arguments.emplace_back(TjsInteger{ 2 });
+    arguments.emplace_back(TjsInteger{ 0 });
+    EXPECT_THROW(call(scaleFunction, std::move(arguments)), std::logic_error);
+
+    arguments.clear();
+    arguments.emplace_back(TjsReal{ 1.5 });
+    arguments.emplace_back(TjsInteger{ -2 });
+    arguments.emplace_back(TjsInteger{ 0 });
+    EXPECT_THROW(call(scaleFunction, std::move(arguments)), std::logic_error);
+
+    // 对象参数按具体类型检查
+    auto builder = call(S_StringBuilderFunction, {});
+    arguments.clear();
+    arguments.emplace_back(builder);
+    arguments.emplace_back(std::string{ "ciallo" });
+    EXPECT_TRUE(call(S_StringBuilderAppendFunction, std::move(arguments)).isVoid());
+
+    arguments.clear();
+    arguments.emplace_back(builder);
+    EXPECT_EQ(call(S_StringBuilderToStringFunction, std::move(arguments)).asString(), "ciallo");
+
+    arguments.clear();
+    arguments.emplace_back(Ciallang::TjsArray{});
+    EXPECT_THROW(call(S_StringBuilderToStringFunction, std::move(arguments)), std::logic_error);
+}
+
+TEST(InterpreterTest, TestIntrinsics) {
+    using Ciallang::TjsValue;
+    using namespace Ciallang::Core;
+
+    auto run = [](const Compiled& compiled, Ciallang::Bytecode::Interpreter& interpreter) {
+        interpreter.global("mathAbs", TjsValue{ S_MathAbsFunction });
+        interpreter.global("mathMin", TjsValue{ S_MathMinFunction });
+        interpreter.global("mathMax", TjsValue{ S_MathMaxFunction });
+        interpreter.run(compiled.chunk.get());
+    };
+
+    // 内建函数直接编译为专用指令, 函数体里也一样
+    const std::string source = R"(
+        var a = mathAbs(0 - 5);
+        var b = mathMin(3, 2.5);
+        var c = mathMax(a, 7);
+        function f(x) {
+            return mathAbs(x);
+        }
+        var d = f(1.5 - 4.0);
+        function g(mathMin) {
+            return mathMin(4);
+        }
+        var e = g(mathAbs);
+        var wide = mathAbs(0 - 1, 2);
+    )";
+    Compiled intrinsic{};
+    ASSERT_NO_FATAL_FAILURE(compile(intrinsic, source));
+
+    Ciallang::Bytecode::Interpreter interpreter{};
+    const auto dump = interpreter.dumpInstruction(*intrinsic.chunk);
+    EXPECT_NE(dump.find("abs "), std::string::npos);
+    EXPECT_NE(dump.find("min "), std::string::npos);
+    EXPECT_NE(dump.find("max "), std::string::npos);
+
+    run(intrinsic, interpreter);
+    EXPECT_EQ(interpreter.global("a").asInteger(), 5);
+    EXPECT_EQ(interpreter.global("b").asReal(), 2.5);
+    EXPECT_EQ(interpreter.global("c").asInteger(), 7);
+    EXPECT_EQ(interpreter.global("d").asReal(), 2.5);
+    // 形参覆盖了内建函数, 参数个数不符, 都走普通调用
+    EXPECT_EQ(interpreter.global("e").asInteger(), 4);
+    EXPECT_EQ(interpreter.global("wide").asInteger(), 1);
+
+    // 关闭后结果不变, 全部走 call
+    Compiled generic{};
+    ASSERT_NO_FATAL_FAILURE(compile(generic, source, false));
+    Ciallang::Bytecode::Interpreter genericInterpreter{};
+    EXPECT_EQ(genericInterpreter.dumpInstruction(*generic.chunk).find("abs "), std::string::npos);
+    run(generic, genericInterpreter);
+    for(const auto* name : { "a", "b", "c", "d", "e", "wide" }) {
+        EXPECT_EQ(genericInterpreter.global(name), interpreter.global(name)) << name;
+    }
+
+    // 脚本里重新定义的同名函数, 即使定义在调用之后也不内联
+    Compiled shadowed{};
+    ASSERT_NO_FATAL_FAILURE(compile(shadowed, R"(
+        function h() {
+            return mathMax(1, 2);
+        }
+        function mathMax(x, y) {
+            return 42;
+        }
+        var m = h();
+    )"));
+    Ciallang::Bytecode::Interpreter shadowedInterpreter{};
+    EXPECT_EQ(shadowedInterpreter.dumpInstruction(*shadowed.chunk).find("max "), std::string::npos);
+    run(shadowed, shadowedInterpreter);
+    EXPECT_EQ(shadowedInterpreter.global("m").asInteger(), 42);
+
+    // 宿主替换了内建函数时, 专用指令退回普通调用
+    std::vector<std::string> lines{};
+    const Ciallang::TjsNativeFunction hostPrintln{
+        [](Ciallang::Bytecode::Interpreter&, const std::span<const TjsValue> arguments, TjsValue* ret, void* context) {
+            static_cast<std::vector<std::string>*>(context)->push_back(fmt::format("{}", arguments[0]));
+            *ret = TjsValue{ Ciallang::TjsInteger{ 1 } };
+        },
+        1, "println", &lines
+    };
+    Compiled hosted{};
+    ASSERT_NO_FATAL_FAILURE(compile(hosted, R"(
+        var printed = println(mathMin(3, 5));
+        var high = mathMax(1, 2);
+    )"));
+    Compiled hostScript{};
+    ASSERT_NO_FATAL_FAILURE(compile(hostScript, R"(
+        function mathMax(x, y) {
+            return 42;
+        }
+    )"));
+
+    Ciallang::Bytecode::Interpreter hostInterpreter{};
+    const auto hostDump = hostInterpreter.dumpInstruction(*hosted.chunk);
+    EXPECT_NE(hostDump.find("println "), std::string::npos);
+    EXPECT_NE(hostDump.find("max "), std::string::npos);
+
+    hostInterpreter.global("println", TjsValue{ hostPrintln });
+    hostInterpreter.global("mathMin", TjsValue{ bindNative<&mathMax>("mathMin") });
+    hostInterpreter.run(hostScript.chunk.get());
+    hostInterpreter.run(hosted.chunk.get());
+    EXPECT_EQ(lines, std::vector<std::string>{ "5" });
+    EXPECT_EQ(hostInterpreter.global("printed").asInteger(), 1);
+    EXPECT_EQ(hostInterpreter.global("high").asInteger(), 42);
+
+    // 宿主没有注册的内建函数与普通调用一样是未定义的全局变量
+    Compiled unregistered{};
+    ASSERT_NO_FATAL_FAILURE(compile(unregistered, "var x = mathAbs(3);"));
+    Ciallang::Bytecode::Interpreter bareInterpreter{};
+    EXPECT_NE(bareInterpreter.dumpInstruction(*unregistered.chunk).find("abs "), std::string::npos);
+    EXPECT_THROW(bareInterpreter.run(unregistered.chunk.get()), std::out_of_range);
+
+    // 整数最小值取反会溢出, 结果转为实数
+    constexpr auto minInteger = std::numeric_limits<Ciallang::TjsInteger>::min();
+    const auto absMin = mathAbs(TjsValue{ minInteger });
+    ASSERT_TRUE(absMin.isReal());
+    EXPECT_EQ(absMin.asReal(), -static_cast<Ciallang::TjsReal>(minInteger));
+    EXPECT_EQ(mathAbs(TjsValue{ minInteger + 1 }).asInteger(), std::numeric_limits<Ciallang::TjsInteger>::max());
+}
+
+TEST(InterpreterTest, TestPolymorphicInlineCache) {
+    using namespace Ciallang::Bytecode;
+    using Ciallang::TjsScriptObject;
+    using Ciallang::TjsValue;
+
+    // 第 k 个对象在 x 前面有 k 个其他成员, 每个对象的形状都不同
+    std::vector<TjsValue> objects{};
+    for(size_t k = 0; k < INLINE_CACHE_ENTRIES + 2; ++k) {
+        TjsScriptObject object{};
+        for(size_t i = 0; i < k; ++i) {
+            object.set(fmt::format("a{}", i), TjsValue{});
+        }
+        object.set("x", TjsValue{ static_cast<Ciallang::TjsInteger>(k) });
+        objects.emplace_back(object);
+    }
+
+    Chunk chunk{};
+    Interpreter interpreter{};
+    interpreter.pushCallFrame(interpreter.createCallFrame(&chunk));
+
+    const Op::GPD gpd{ Register{ 1 }, Register{ 0 }, Ciallang::TjsStringTable::intern("x") };
+    auto get = [&](const size_t k) {
+        interpreter.reg(Register{ 0 }, TjsValue{ objects[k] });
+        gpd.execute(interpreter);
+        return interpreter.reg(Register{ 1 }).asInteger();
+    };
+
+    EXPECT_EQ(gpd.cache().state(), InlineCacheState::Uninitialized);
+    EXPECT_EQ(get(0), 0);
+    EXPECT_EQ(get(0), 0);
+    EXPECT_EQ(gpd.cache().state(), InlineCacheState::Monomorphic);
+
+    for(size_t k = 1; k < INLINE_CACHE_ENTRIES; ++k) {
+        EXPECT_EQ(get(k), k);
+        EXPECT_EQ(get(k), k);
+    }
+    EXPECT_EQ(gpd.cache().state(), InlineCacheState::Polymorphic);
+    EXPECT_EQ(interpreter.cacheStats().hits, INLINE_CACHE_ENTRIES);
+    EXPECT_EQ(interpreter.cacheStats().misses, INLINE_CACHE_ENTRIES);
+
+    // 第五个形状, 退化为 megamorphic, 之后走 stub cache
+    EXPECT_EQ(get(INLINE_CACHE_ENTRIES), INLINE_CACHE_ENTRIES);
+    EXPECT_EQ(gpd.cache().state(), InlineCacheState::Megamorphic);
+    EXPECT_EQ(interpreter.cacheStats().megamorphicSites, 1);
+
+    EXPECT_EQ(get(INLINE_CACHE_ENTRIES), INLINE_CACHE_ENTRIES);
+    EXPECT_EQ(get(INLINE_CACHE_ENTRIES + 1), INLINE_CACHE_ENTRIES + 1);
+    EXPECT_EQ(get(INLINE_CACHE_ENTRIES + 1), INLINE_CACHE_ENTRIES + 1);
+    EXPECT_EQ(get(0), 0);
+    EXPECT_EQ(interpreter.cacheStats().stubHits, 2);
+    EXPECT_EQ(interpreter.cacheStats().stubMisses, 2);
+
+    EXPECT_NE(interpreter.dumpCacheStats().find("megamorphic sites: 1"), std::string::npos);
+}
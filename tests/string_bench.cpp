@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2024/11/10 下午3:05
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#include <gflags/gflags.h>
+
+#include "../src/common/SourceFile.hpp"
+#include "../src/core/string.hpp"
+#include "../src/gen/BytecodeGen.hpp"
+#include "../src/init/GlogInit.hpp"
+#include "../src/parser/Parser.hpp"
+#include "../src/vm/Interpreter.hpp"
+
+/**
+ * 字符串库基准测试, 对每个操作比较原生函数和只用单个码点访问写成的脚本实现
+ *
+ *     string_bench --bench_workload=replace --bench_size_kb=256
+ *
+ * 脚本实现通过 strSubstring(s, i, 1) 逐个访问码点, 代表没有原生库时脚本能写出的版本
+ */
+
+DEFINE_string(bench_workload, "all", "index-of, replace, trim or all");
+
+DEFINE_uint32(bench_size_kb, 64, "input text size in KiB");
+
+DEFINE_uint32(bench_rounds, 3, "rounds per implementation, the best one is reported");
+
+using namespace Ciallang;
+
+namespace {
+    struct Workload {
+        std::string name;
+        std::string native;
+        std::string script;
+    };
+
+    // 还没有实现 break, 脚本用条件变量结束循环
+    const Workload S_Workloads[] = {
+            {
+                "index-of",
+                R"(var r = strIndexOf(text, needle);)",
+                R"(
+                    var n = strLength(text);
+                    var m = strLength(needle);
+                    var r = 0 - 1;
+                    var i = 0;
+                    while(i <= n - m) {
+                        if(strSubstring(text, i, m) == needle) {
+                            r = i;
+                            i = n;
+                        } else {
+                            i += 1;
+                        }
+                    }
+                )"
+            },
+            {
+                "replace",
+                R"(var r = strReplace(text, ", ", "; ");)",
+                R"(
+                    var n = strLength(text);
+                    var r = "";
+                    var i = 0;
+                    while(i < n) {
+                        if(strSubstring(text, i, 2) == ", ") {
+                            r += "; ";
+                            i += 2;
+                        } else {
+                            r += strSubstring(text, i, 1);
+                            i += 1;
+                        }
+                    }
+                )"
+            },
+            {
+                "trim",
+                R"(var r = strTrim(padded);)",
+                R"(
+                    var begin = 0;
+                    var end = strLength(padded);
+                    var scanning = 1;
+                    while(scanning) {
+                        if(strSubstring(padded, begin, 1) == " ") {
+                            begin += 1;
+                        } else {
+                            scanning = 0;
+                        }
+                    }
+                    scanning = 1;
+                    while(scanning) {
+                        if(strSubstring(padded, end - 1, 1) == " ") {
+                            end -= 1;
+                        } else {
+                            scanning = 0;
+                        }
+                    }
+                    var r = strSubstring(padded, begin, end - begin);
+                )"
+            },
+    };
+
+    // 中英文混合的单词, 以 ", " 分隔, 末尾放一个只出现一次的 needle
+    std::string makeText(const size_t size) {
+        static const std::string words[]{ "ciallo", "script", "中文", "rope", "文字列", "value" };
+
+        std::string text{};
+        for(size_t i = 0; text.size() < size; ++i) {
+            text += words[i % std::size(words)];
+            text += ", ";
+        }
+        return text + "needle";
+    }
+
+    std::unique_ptr<Bytecode::Chunk> compile(Common::SourceFile& sourceFile, const std::string& source) {
+        Common::Result r{};
+        sourceFile.load(r, source);
+
+        Syntax::AstBuilder astBuilder{};
+        Syntax::Parser parser{ sourceFile, astBuilder };
+        auto* globalNode = parser.parse(r);
+        CHECK(!r.isFailed()) << "parse failed: " << source;
+
+        Inter::BytecodeGen codeGen{ sourceFile };
+        auto chunk = codeGen.parseAst(r, globalNode);
+        CHECK(chunk) << "codegen failed: " << source;
+        return chunk;
+    }
+
+    std::pair<double, TjsValue> measure(const std::string& source, const std::string& text) {
+        Common::SourceFile sourceFile{};
+        const auto chunk = compile(sourceFile, source);
+
+        const std::string spaces(1024, ' ');
+        double best = std::numeric_limits<double>::max();
+        TjsValue result{};
+        for(uint32_t round = 0; round < std::max(FLAGS_bench_rounds, 1u); ++round) {
+            Bytecode::Interpreter interpreter{};
+            interpreter.global("strLength", TjsValue{ Core::S_StringLengthFunction });
+            interpreter.global("strIndexOf", TjsValue{ Core::S_StringIndexOfFunction });
+            interpreter.global("strSubstring", TjsValue{ Core::S_StringSubstringFunction });
+            interpreter.global("strReplace", TjsValue{ Core::S_StringReplaceFunction });
+            interpreter.global("strTrim", TjsValue{ Core::S_StringTrimFunction });
+            interpreter.global("text", TjsValue{ text });
+            interpreter.global("needle", TjsValue{ std::string{ "needle" } });
+            interpreter.global("padded", TjsValue{ spaces + text + spaces });
+
+            const auto begin = std::chrono::steady_clock::now();
+            interpreter.run(chunk.get());
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+
+            best = std::min(best, elapsed.count());
+            result = TjsValue{ interpreter.global("r") };
+        }
+        return { best, std::move(result) };
+    }
+
+    void run(const Workload& workload) {
+        const auto text = makeText(static_cast<size_t>(FLAGS_bench_size_kb) * 1024);
+
+        const auto [nativeMillis, nativeResult] = measure(workload.native, text);
+        const auto [scriptMillis, scriptResult] = measure(workload.script, text);
+        CHECK(nativeResult == scriptResult) << workload.name << ": results differ";
+
+        fmt::println(
+            "{: <10} {: >12.3f} {: >12.3f} {: >9.1f}x",
+            workload.name, nativeMillis, scriptMillis, scriptMillis / nativeMillis
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    Ciallang::Init::InitializeGlog(argc, argv);
+
+    fmt::println("{: <10} {: >12} {: >12} {: >10}", "workload", "native(ms)", "script(ms)", "speedup");
+
+    bool found = false;
+    for(const auto& workload : S_Workloads) {
+        if(FLAGS_bench_workload != "all" && FLAGS_bench_workload != workload.name) continue;
+
+        found = true;
+        run(workload);
+    }
+
+    if(!found) {
+        LOG(ERROR) << "Unknown workload: " << FLAGS_bench_workload;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2024/11/9 下午7:45
+ *
+ * /\  _` \   __          /\_ \  /\_ \
+ * \ \ \/\_\ /\_\     __  \//\ \ \//\ \      __      ___      __
+ *  \ \ \/_/_\/\ \  /'__`\  \ \ \  \ \ \   /'__`\  /' _ `\  /'_ `\
+ *   \ \ \L\ \\ \ \/\ \L\.\_ \_\ \_ \_\ \_/\ \L\.\_/\ \/\ \/\ \L\ \
+ *    \ \____/ \ \_\ \__/.\_\/\____\/\____\ \__/.\_\ \_\ \_\ \____ \
+ *     \/___/   \/_/\/__/\/_/\/____/\/____/\/__/\/_/\/_/\/_/\/___L\ \
+ *                                                            /\____/
+ *                                                            \_/__/
+ *
+ */
+#include <random>
+
+#include <gflags/gflags.h>
+
+#include "../src/common/SourceFile.hpp"
+#include "../src/common/UTF8.hpp"
+#include "../src/init/GlogInit.hpp"
+
+/**
+ * UTF-8 基准测试, 对每种输入输出校验, 计数和载入源文件的吞吐量
+ *
+ *     utf8_bench --bench_input=cjk --bench_size_mb=64
+ *
+ * scalar 是逐字节的实现, 与 SIMD 路径 (按编译选项选择 AVX2, SSE4.1 或 SSE2) 对照
+ */
+
+DEFINE_string(bench_input, "all", "ascii, mixed, cjk or all");
+
+DEFINE_uint32(bench_size_mb, 16, "input size in MiB");
+
+DEFINE_uint32(bench_rounds, 5, "rounds per operation, the best one is reported");
+
+using namespace Ciallang::Common;
+
+namespace {
+    // 按比例随机拼接 ASCII 和多字节字符, 以换行分隔成 80 字节左右的行
+    std::string makeInput(const size_t size, const int asciiPercent) {
+        static const std::string wide[]{ "\xc3\xa9", "\xe4\xb8\xad", "\xe3\x81\x82", "\xf0\x9f\x98\x80" };
+
+        std::mt19937 random{ 42 };
+        std::string text{};
+        text.reserve(size + 4);
+        while(text.size() < size) {
+            if(text.size() % 80 == 79) {
+                text += '\n';
+            } else if(static_cast<int>(random() % 100) < asciiPercent) {
+                text += static_cast<char>('a' + random() % 26);
+            } else {
+                text += wide[random() % std::size(wide)];
+            }
+        }
+        return text;
+    }
+
+    volatile size_t S_Sink = 0;
+
+    template <typename F>
+    void measure(const std::string& input, const std::string& operation, const std::string& text, F&& run) {
+        std::chrono::duration<double> best{ std::numeric_limits<double>::max() };
+        for(uint32_t round = 0; round < std::max(FLAGS_bench_rounds, 1u); ++round) {
+            const auto begin = std::chrono::steady_clock::now();
+            S_Sink = S_Sink + run(text);
+            best = std::min<std::chrono::duration<double>>(best, std::chrono::steady_clock::now() - begin);
+        }
+
+        fmt::println(
+            "{: <8} {: <16} {: >10.1f}",
+            input, operation,
+            static_cast<double>(text.size()) / (1024 * 1024) / best.count()
+        );
+    }
+
+    void run(const std::string& input, const int asciiPercent) {
+        const auto text = makeInput(static_cast<size_t>(FLAGS_bench_size_mb) * 1024 * 1024, asciiPercent);
+        CHECK(utf8Validate(text.data(), text.size()));
+
+        measure(input, "validate-scalar", text, [](const std::string& s) {
+            return static_cast<size_t>(utf8ValidateScalar(s.data(), s.size()));
+        });
+        measure(input, "validate", text, [](const std::string& s) {
+            return static_cast<size_t>(utf8Validate(s.data(), s.size()));
+        });
+        measure(input, "count-scalar", text, [](const std::string& s) {
+            return utf8CountScalar(s.data(), s.size());
+        });
+        measure(input, "count", text, [](const std::string& s) {
+            return utf8Count(s.data(), s.size());
+        });
+        measure(input, "source-load", text, [](const std::string& s) {
+            Result r{};
+            SourceFile sourceFile{};
+            sourceFile.load(r, s);
+            return sourceFile.numberOfLines();
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    Ciallang::Init::InitializeGlog(argc, argv);
+
+    const std::pair<std::string, int> inputs[] = {
+            { "ascii", 100 },
+            { "mixed", 90 },
+            { "cjk", 10 },
+    };
+
+    fmt::println("{: <8} {: <16} {: >10}", "input", "operation", "MB/s");
+
+    bool found = false;
+    for(const auto& [name, asciiPercent] : inputs) {
+        if(FLAGS_bench_input != "all" && FLAGS_bench_input != name) continue;
+
+        found = true;
+        run(name, asciiPercent);
+    }
+
+    if(!found) {
+        LOG(ERROR) << "Unknown input: " << FLAGS_bench_input;
+        return 1;
+    }
+    return 0;
+}